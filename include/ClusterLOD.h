@@ -0,0 +1,104 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "GTS.h"
+
+namespace cluster_lod {
+    using Position = std::array<float, 3>;
+
+    struct Sphere {
+        Position center = {0.f, 0.f, 0.f};
+        float    radius = 0.f;
+    };
+
+    struct Meshlet {
+        // 3 vertex indices per triangle, indexing the positions passed to BuildClusterDAG
+        std::vector<int>    triangles;
+        gts::EncodedMeshlet encoded;
+        Sphere              bounds;
+
+        // level 0 is the input mesh
+        int level       = 0;
+        // group whose simplification created this meshlet, -1 for level 0
+        int sourceGroup = -1;
+        // group this meshlet was simplified in, -1 if the meshlet is a root of the DAG
+        int group       = -1;
+
+        // Largest quadric error of the simplifications that led to this meshlet. Each is measured against the level it
+        // simplified, not the input mesh, so this is a monotonic bound for selection rather than the deviation from the
+        // input. Equal for all meshlets of a source group.
+        float  lodError = 0.f;
+        Sphere lodBounds;
+        // Error of the meshlets replacing this one. Equal for all meshlets of a group.
+        float  parentError = std::numeric_limits<float>::infinity();
+        Sphere parentBounds;
+    };
+
+    struct Group {
+        int              level = 0;
+        // meshlets that were merged and simplified
+        std::vector<int> children;
+        // meshlets created by splitting the simplified group
+        std::vector<int> parents;
+        float            error = 0.f;
+        Sphere           bounds;
+    };
+
+    struct ClusterDAG {
+        std::vector<Meshlet> meshlets;
+        std::vector<Group>   groups;
+        int                  levelCount = 0;
+    };
+
+    struct BuildOptions {
+        // at most the limits of the GTS encoding
+        int                          maxTriangles  = gts::kMaxMeshletTriangles;
+        int                          maxVertices   = gts::kMaxMeshletVertices;
+        // meshlets merged per group
+        int                          groupSize     = 4;
+        // target triangle count of a simplified group relative to its input
+        float                        simplifyRatio = 0.5f;
+        // groups that cannot be simplified below this ratio are not replaced
+        float                        minReduction  = 0.85f;
+        // gts::kBridgedStripOptions reduces the encoded size of meshlets with poor connectivity
+        optimal_strips::StripOptions stripOptions;
+        // 0 uses all hardware threads
+        int                          threadCount = 0;
+    };
+
+    // Builds a hierarchy of meshlets. Every level groups neighboring meshlets, simplifies each group with locked
+    // group boundaries and splits the result into new meshlets. All meshlets are encoded with optimal strips.
+    // Positions are 3 floats per vertex; indices are 3 vertex indices per counter-clockwise triangle. Degenerate
+    // triangles are ignored. Throws std::invalid_argument for vertex indices out of range and for meshlet limits above
+    // those of the GTS encoding.
+    ClusterDAG BuildClusterDAG(std::span<const float> positions,
+                               std::span<const int>   indices,
+                               const BuildOptions&    options = {});
+
+    // Greedily grows meshlets over vertex-adjacent triangles, preferring triangles that add few new vertices, then
+    // triangles enclosed by assigned ones and then triangles close to the meshlet center. Fragments below a quarter of
+    // maxTriangles are merged into a neighbor or regrown together with it. Positions may be empty, in which case only
+    // vertex reuse is considered.
+    std::vector<std::vector<int>> BuildMeshlets(std::span<const float> positions,
+                                                std::span<const int>   triangles,
+                                                int                    maxTriangles,
+                                                int                    maxVertices);
+
+    // Selects the meshlets that form a crack-free cut of the DAG for the given view. A meshlet is selected if its own
+    // error is below the threshold and the error of its parents is not, with errors divided by the view distance.
+    std::vector<int> SelectMeshlets(const ClusterDAG& dag, const Position& viewPosition, float errorThreshold);
+}  // namespace cluster_lod
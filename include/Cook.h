@@ -0,0 +1,101 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "GTS.h"
+
+// Protocol of the local cook daemon. Messages are exchanged over a Unix domain socket as a header followed by a
+// payload in host byte order, as client and daemon always run on the same machine.
+namespace cook {
+    constexpr std::uint32_t kProtocolMagic   = 0x4b4f4f43;  // "COOK"
+    constexpr std::uint32_t kProtocolVersion = 1;
+
+    // Interactive jobs are always scheduled before batch jobs
+    enum class Priority : std::uint8_t { INTERACTIVE, BATCH };
+
+    enum class JobKind : std::uint8_t {
+        // a single meshlet, split by the daemon only if it exceeds the limits of the GTS encoding
+        MESHLET,
+        // a mesh the daemon splits into meshlets
+        MESH,
+    };
+
+    struct Job {
+        // chosen by the client to match results to jobs
+        std::uint64_t      id            = 0;
+        Priority           priority      = Priority::BATCH;
+        JobKind            kind          = JobKind::MESH;
+        // use gts::kBridgedStripOptions instead of plain strips
+        bool               bridgedStrips = false;
+        // 3 floats per vertex, used to build compact meshlets. May be empty for meshlet jobs.
+        std::vector<float> positions;
+        // 3 vertex indices per counter-clockwise triangle
+        std::vector<int>   indices;
+    };
+
+    // Sent for every meshlet as soon as it is encoded, in order of completion
+    struct MeshletResult {
+        std::uint64_t       jobId  = 0;
+        // the meshlet was served from the result cache of the daemon
+        bool                cached = false;
+        std::vector<int>    triangles;
+        gts::EncodedMeshlet encoded;
+    };
+
+    // Sent after the last meshlet of a job
+    struct JobComplete {
+        std::uint64_t jobId        = 0;
+        std::uint32_t meshletCount = 0;
+    };
+
+    // Sent instead of JobComplete if a job failed. Meshlets sent before remain valid.
+    struct JobError {
+        std::uint64_t jobId = 0;
+        std::string   message;
+    };
+
+    using Response = std::variant<MeshletResult, JobComplete, JobError>;
+
+    // $XDG_RUNTIME_DIR/optimal-strips-cook.sock, or a per-user path in /tmp
+    std::string DefaultSocketPath();
+
+    // Blocking message IO on a connected socket. Reads return nullopt if the peer closed the connection between
+    // messages and throw std::runtime_error on IO errors and malformed messages. Writes to a closed peer throw as well
+    // and never raise SIGPIPE.
+    void                    WriteJob(int fd, const Job& job);
+    std::optional<Job>      ReadJob(int fd);
+    void                    WriteResponse(int fd, const Response& response);
+    std::optional<Response> ReadResponse(int fd);
+
+    // Connection to the daemon. Submit and Receive may be called from two different threads.
+    class Client {
+    private:
+        int           fd_        = -1;
+        std::uint64_t nextJobId_ = 1;
+
+    public:
+        explicit Client(const std::string& socketPath = DefaultSocketPath());
+        ~Client();
+        Client(const Client&)            = delete;
+        Client& operator=(const Client&) = delete;
+
+        // Assigns and returns a new job id
+        std::uint64_t Submit(Job job);
+        // Blocks until the next response arrives. Returns nullopt if the daemon closed the connection.
+        std::optional<Response> Receive();
+    };
+}  // namespace cook
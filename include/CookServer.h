@@ -0,0 +1,92 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Cook.h"
+
+namespace cook {
+    struct ServerOptions {
+        std::string socketPath             = DefaultSocketPath();
+        // solver threads, 0 uses all hardware threads
+        int         workerCount            = 0;
+        // Workers that only take interactive jobs, so that these never wait for a running batch solve.
+        // At least one worker always takes batch jobs.
+        int         interactiveWorkerCount = 1;
+        // encoded meshlets kept in the result cache shared by all clients
+        std::size_t cacheCapacity          = 1 << 16;
+    };
+
+    struct ServerStatistics {
+        std::uint64_t jobs       = 0;
+        std::uint64_t failedJobs = 0;
+        // meshlets sent to clients, including cache hits
+        std::uint64_t meshlets   = 0;
+        std::uint64_t cacheHits  = 0;
+        // meshlets passed to the strip optimizer, including meshlets that had to be split
+        std::uint64_t solves     = 0;
+    };
+
+    class Connection;
+    class ResultCache;
+    class TaskQueue;
+    struct Task;
+
+    // Cooks meshlet and mesh jobs of local clients. Every worker thread keeps a warm MILP solver, and meshlets are
+    // streamed back to the submitting client as soon as they are encoded. Jobs of disconnected clients are dropped.
+    class Server {
+    private:
+        ServerOptions                          options_;
+        int                                    listenFd_   = -1;
+        // Stop writes to the pipe to wake up Run
+        int                                    wakeFds_[2] = {-1, -1};
+        std::atomic<bool>                      stopping_   = false;
+        std::unique_ptr<TaskQueue>             queue_;
+        std::unique_ptr<ResultCache>           cache_;
+        std::vector<std::thread>               workers_;
+        std::list<std::shared_ptr<Connection>> connections_;
+        std::atomic<std::uint64_t>             jobs_       = 0;
+        std::atomic<std::uint64_t>             failedJobs_ = 0;
+        std::atomic<std::uint64_t>             meshlets_   = 0;
+        std::atomic<std::uint64_t>             cacheHits_  = 0;
+        std::atomic<std::uint64_t>             solves_     = 0;
+
+        void Accept();
+        void Shutdown();
+        void ServeConnection(const std::shared_ptr<Connection>& connection);
+        void Submit(const std::shared_ptr<Connection>& connection, Job&& job);
+        void Work(milp::MILPSolverBase& solver, bool interactiveOnly);
+        void Split(const Task& task);
+        void Solve(const Task& task, milp::MILPSolverBase& solver, const std::vector<int>& triangles);
+
+    public:
+        // Binds the socket, replacing a stale socket file. Throws if another daemon is listening on it.
+        explicit Server(ServerOptions options);
+        ~Server();
+        Server(const Server&)            = delete;
+        Server& operator=(const Server&) = delete;
+
+        // Starts the workers and accepts connections until Stop is called
+        void Run();
+        // May be called from any thread. Pending jobs are dropped.
+        void Stop();
+
+        ServerStatistics GetStatistics() const;
+    };
+}  // namespace cook
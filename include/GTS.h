@@ -0,0 +1,74 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "OptimalStrips.h"
+
+namespace gts {
+    // Limits of the mesh shader in hlsl/GTS.hlsl
+    constexpr int kMaxMeshletTriangles = 256;
+    constexpr int kMaxMeshletVertices  = 128;
+
+    // 256 x 1 bit L/R flags = 8 DWORDs, followed by the 8-bit vertex indices
+    constexpr int kTriangleFlagDwords = kMaxMeshletTriangles / 32;
+
+    // 8-bit vertex index and L/R flag
+    constexpr int kBitsPerTriangle = 9;
+
+    // Strips are concatenated with degenerate triangles, as the decoder only knows a single strip start.
+    // Continuing at a triangle that shares a vertex with the previous one is cheaper than a full restart.
+    constexpr int kRestartTriangles = 4;
+    constexpr int kBridgeTriangles  = 2;
+
+    // Lets the strip optimizer trade restarts for bridges. Every remaining strip break is charged kRestartTriangles,
+    // which is what EncodeMeshlet pays for it in the strips from CreateMeshletStrips.
+    constexpr optimal_strips::StripOptions kBridgedStripOptions = {
+        .allowBridges = true,
+        .restartCost  = kRestartTriangles * kBitsPerTriangle,
+        .bridgeCost   = kBridgeTriangles * kBitsPerTriangle,
+    };
+
+    struct EncodedMeshlet {
+        // Maps meshlet-local vertex index to the vertex index of the input triangles.
+        // Local indices are assigned in order of first use in the strip.
+        std::vector<int>           vertices;
+        // Number of primitives the decoder outputs, including degenerate triangles
+        std::uint32_t              primitiveCount = 0;
+        // L/R flags and 8-bit vertex indices as loaded into IndexBufferCache by GTS.hlsl
+        std::vector<std::uint32_t> data;
+    };
+
+    // Creates optimal strips in the order EncodeMeshlet writes them. Strips without bridges are reordered and reversed
+    // to join them with as few degenerate triangles as possible. With options.allowBridges, the optimizer already
+    // considers every join cheaper than a restart, so its order is kept and each break costs the restart it charged.
+    std::vector<optimal_strips::TriangleStrip> CreateMeshletStrips(std::span<const int>                triangles,
+                                                                   const optimal_strips::StripOptions& options);
+    std::vector<optimal_strips::TriangleStrip> CreateMeshletStrips(std::span<const int>                triangles,
+                                                                   const optimal_strips::StripOptions& options,
+                                                                   milp::MILPSolverBase&               solver);
+
+    // Number of primitives EncodeMeshlet will emit for the given strips. Throws like EncodeMeshlet.
+    int EncodedPrimitiveCount(std::span<const int> triangles, const std::vector<optimal_strips::TriangleStrip>& strips);
+
+    // Encodes the triangles of a meshlet as one generalized triangle strip in the layout of hlsl/GTS.hlsl.
+    // Strips are written in the given order, see CreateMeshletStrips, and joined by as few degenerate triangles as
+    // possible. Throws std::invalid_argument for triangles with repeated vertices, which would not decode correctly.
+    EncodedMeshlet EncodeMeshlet(std::span<const int>                              triangles,
+                                 const std::vector<optimal_strips::TriangleStrip>& strips);
+
+    // Reference implementation of LoadTriangle in hlsl/GTS.hlsl. Returns meshlet-local vertex indices.
+    std::vector<std::array<std::uint32_t, 3>> DecodeMeshlet(const EncodedMeshlet& meshlet);
+}  // namespace gts
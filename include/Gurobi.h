@@ -12,6 +12,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <MILP.h>
 #include <gurobi_c++.h>
 
+#include <memory>
+#include <vector>
+
 namespace gurobi {
     class GUROBISolver : public milp::MILPSolverBase {
         friend class StripOptimizerLazyGurobi;
@@ -32,6 +35,7 @@ namespace gurobi {
         void   SetObjective(bool maximize) override;
         void   Optimize() override;
         double GetSolutionVariableValue(var v);
+        void   Reset() override;
 
     private:
         var AddVariableImpl(double min, double max, double objFactor, char type);
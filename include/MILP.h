@@ -9,6 +9,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 
 #pragma once
+#include <cstdint>
 #include <unordered_map>
 
 namespace milp {
@@ -39,5 +40,7 @@ namespace milp {
         virtual void   SetObjective(bool maximize)                                            = 0;
         virtual void   Optimize()                                                             = 0;
         virtual double GetSolutionVariableValue(var)                                          = 0;
+        // removes all variables and constraints, but keeps the solver environment for the next model
+        virtual void Reset() = 0;
     };
 }  // namespace milp
\ No newline at end of file
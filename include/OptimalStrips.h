@@ -10,6 +10,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #pragma once
 
+#include <memory>
 #include <span>
 #include <vector>
 
@@ -18,5 +19,23 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 namespace optimal_strips {
     using TriangleId = std::int32_t;
     using TriangleStrip = std::vector<TriangleId>;
+
+    struct StripOptions {
+        // Allows consecutive strip triangles that only share a vertex. Such a bridge is cheaper to encode than
+        // starting a new strip, but more expensive than continuing over an edge.
+        bool   allowBridges = false;
+        // encoded size of starting a new strip and of a bridge, e.g. in bits
+        double restartCost  = 2.;
+        double bridgeCost   = 1.;
+    };
+
+    // Creates the MILP solver selected at build time
+    std::unique_ptr<milp::MILPSolverBase> CreateSolver();
+
     std::vector<TriangleStrip> CreateTriangleStrips(std::span<const int> triangles);
+    std::vector<TriangleStrip> CreateTriangleStrips(std::span<const int> triangles, const StripOptions& options);
+    // Reuses a solver from CreateSolver, which is reset first, to avoid its startup cost when solving many meshlets.
+    std::vector<TriangleStrip> CreateTriangleStrips(std::span<const int>  triangles,
+                                                    const StripOptions&   options,
+                                                    milp::MILPSolverBase& solver);
 }  // namespace optimal_strips
\ No newline at end of file
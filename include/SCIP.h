@@ -13,6 +13,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <MILP.h>
 #include <scip/scip.h>
 
+#include <vector>
+
 namespace scip {
     class SCIPSolver : public milp::MILPSolverBase {
     private:
@@ -29,6 +31,7 @@ namespace scip {
         void   SetObjective(bool maximize) override;
         void   Optimize() override;
         double GetSolutionVariableValue(var v);
+        void   Reset() override;
         var    AddVariableImpl(double min, double max, double objFactor, SCIP_VARTYPE type);
         void   SCIPthrow(SCIP_RETCODE code);
     };
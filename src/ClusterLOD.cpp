@@ -0,0 +1,959 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <ClusterLOD.h>
+#include <OptimalStrips.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace cluster_lod {
+    using Edge = std::pair<int, int>;
+
+    struct EdgeHash {
+        std::size_t operator()(const Edge& edge) const
+        {
+            const auto hasher = std::hash<std::int64_t>();
+            return hasher((static_cast<std::int64_t>(edge.first) << 32) ^ static_cast<std::uint32_t>(edge.second));
+        }
+    };
+
+    int GetThreadCount(int threadCount)
+    {
+        return threadCount > 0 ? threadCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    // runs fn(i, worker) for all i in [0, count) on a pool of threads and rethrows the first exception. The worker
+    // index is below GetThreadCount(threadCount) and identifies the calling thread, e.g. to reuse per-thread state.
+    template <typename Function>
+    void ParallelFor(int count, int threadCount, const Function& fn)
+    {
+        threadCount = std::min(GetThreadCount(threadCount), count);
+
+        std::atomic<int>   next = 0;
+        std::exception_ptr error;
+        std::mutex         errorMutex;
+
+        const auto worker = [&](int workerIndex) {
+            for (int i = next++; i < count; i = next++) {
+                try {
+                    fn(i, workerIndex);
+                } catch (...) {
+                    std::lock_guard lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; ++t) {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    Position GetPosition(std::span<const float> positions, int vertex)
+    {
+        return {positions[3 * vertex + 0], positions[3 * vertex + 1], positions[3 * vertex + 2]};
+    }
+
+    Position operator-(const Position& a, const Position& b)
+    {
+        return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+    }
+
+    float Dot(const Position& a, const Position& b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    Position Cross(const Position& a, const Position& b)
+    {
+        return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+    }
+
+    float Length(const Position& a)
+    {
+        return std::sqrt(Dot(a, a));
+    }
+
+    // Ritter's bounding sphere
+    Sphere ComputeBounds(std::span<const float> positions, std::span<const int> triangles)
+    {
+        if (triangles.empty()) {
+            return {};
+        }
+        const auto farthest = [&](const Position& from) {
+            Position result   = from;
+            float    distance = 0.f;
+            for (const int v : triangles) {
+                const auto p = GetPosition(positions, v);
+                const auto d = Length(p - from);
+                if (d > distance) {
+                    result   = p;
+                    distance = d;
+                }
+            }
+            return result;
+        };
+
+        const auto a = farthest(GetPosition(positions, triangles[0]));
+        const auto b = farthest(a);
+
+        Sphere sphere;
+        sphere.center = {(a[0] + b[0]) * .5f, (a[1] + b[1]) * .5f, (a[2] + b[2]) * .5f};
+        sphere.radius = Length(b - a) * .5f;
+
+        for (const int v : triangles) {
+            const auto p = GetPosition(positions, v);
+            const auto d = Length(p - sphere.center);
+            if (d > sphere.radius) {
+                // grow sphere to touch its old back side and p
+                const float radius = (sphere.radius + d) * .5f;
+                const float shift  = (radius - sphere.radius) / d;
+                for (int i = 0; i < 3; ++i) {
+                    sphere.center[i] += (p[i] - sphere.center[i]) * shift;
+                }
+                sphere.radius = radius;
+            }
+        }
+        return sphere;
+    }
+
+    Sphere MergeSpheres(const Sphere& a, const Sphere& b)
+    {
+        const float distance = Length(b.center - a.center);
+        if (a.radius >= distance + b.radius) {
+            return a;
+        }
+        if (b.radius >= distance + a.radius) {
+            return b;
+        }
+
+        Sphere result;
+        result.radius     = (distance + a.radius + b.radius) * .5f;
+        const float shift = (result.radius - a.radius) / distance;
+        for (int i = 0; i < 3; ++i) {
+            result.center[i] = a.center[i] + (b.center[i] - a.center[i]) * shift;
+        }
+        return result;
+    }
+
+    // Greedily grows meshlets over vertex-adjacent triangles, preferring triangles that add few new vertices and close
+    // holes. Fragments left between finished meshlets are merged into a neighbor, or split evenly with a full one.
+    std::vector<std::vector<int>> BuildMeshlets(std::span<const float> positions,
+                                                std::span<const int>   triangles,
+                                                int                    maxTriangles,
+                                                int                    maxVertices)
+    {
+        const int triangleCount = static_cast<int>(triangles.size() / 3);
+
+        std::unordered_map<int, std::vector<int>>            vertexTriangles;
+        std::unordered_map<Edge, std::vector<int>, EdgeHash> edgeTriangles;
+        std::vector<Position>                                centers(triangleCount);
+        for (int t = 0; t < triangleCount; ++t) {
+            for (int corner = 0; corner < 3; ++corner) {
+                const int  v = triangles[3 * t + corner];
+                const auto p = positions.empty() ? Position{0.f, 0.f, 0.f} : GetPosition(positions, v);
+                vertexTriangles[v].emplace_back(t);
+                edgeTriangles[std::minmax(v, triangles[3 * t + (corner + 1) % 3])].emplace_back(t);
+                for (int i = 0; i < 3; ++i) {
+                    centers[t][i] += p[i] / 3.f;
+                }
+            }
+        }
+
+        std::vector<std::vector<int>> meshlets;
+        std::vector<int>              meshletOf(triangleCount, -1);
+        std::vector<int>              frontier;
+
+        // number of edges shared with assigned triangles or on the mesh border
+        const auto enclosure = [&](int t) {
+            int count = 0;
+            for (int corner = 0; corner < 3; ++corner) {
+                const Edge edge     = std::minmax(triangles[3 * t + corner], triangles[3 * t + (corner + 1) % 3]);
+                bool       enclosed = true;
+                for (const int other : edgeTriangles.at(edge)) {
+                    enclosed &= other == t || meshletOf[other] >= 0;
+                }
+                count += enclosed ? 1 : 0;
+            }
+            return count;
+        };
+
+        // starting in the most enclosed triangle leaves no pockets behind
+        const auto findSeed = [&](const std::vector<int>& candidates) {
+            int seed         = -1;
+            int seedEnclosed = -1;
+            for (const int t : candidates) {
+                if (meshletOf[t] < 0 && enclosure(t) > seedEnclosed) {
+                    seed         = t;
+                    seedEnclosed = enclosure(t);
+                }
+            }
+            return seed;
+        };
+
+        const auto grow = [&](int meshletIndex, int seed, int limit) {
+            std::vector<int>&       meshlet = meshlets[meshletIndex];
+            std::unordered_set<int> vertices;
+            std::unordered_set<int> inFrontier;
+            Position                centerSum = {0.f, 0.f, 0.f};
+            frontier.clear();
+
+            const auto add = [&](int t) {
+                meshletOf[t] = meshletIndex;
+                meshlet.emplace_back(t);
+                for (int i = 0; i < 3; ++i) {
+                    centerSum[i] += centers[t][i];
+                }
+                for (int corner = 0; corner < 3; ++corner) {
+                    const int v = triangles[3 * t + corner];
+                    vertices.insert(v);
+                    for (const int other : vertexTriangles[v]) {
+                        if (meshletOf[other] < 0 && inFrontier.insert(other).second) {
+                            frontier.emplace_back(other);
+                        }
+                    }
+                }
+            };
+
+            add(seed);
+            while (static_cast<int>(meshlet.size()) < limit) {
+                std::erase_if(frontier, [&](int t) { return meshletOf[t] >= 0; });
+
+                const float    scale  = 1.f / static_cast<float>(meshlet.size());
+                const Position center = {centerSum[0] * scale, centerSum[1] * scale, centerSum[2] * scale};
+
+                int   best         = -1;
+                int   bestNew      = 4;
+                int   bestEnclosed = -1;
+                float bestDistance = std::numeric_limits<float>::max();
+                for (const int t : frontier) {
+                    int newVertices = 0;
+                    for (int corner = 0; corner < 3; ++corner) {
+                        newVertices += vertices.contains(triangles[3 * t + corner]) ? 0 : 1;
+                    }
+                    if (newVertices > bestNew || static_cast<int>(vertices.size()) + newVertices > maxVertices) {
+                        continue;
+                    }
+                    const int   enclosed = enclosure(t);
+                    const float distance = Dot(centers[t] - center, centers[t] - center);
+                    if (newVertices < bestNew || enclosed > bestEnclosed ||
+                        (enclosed == bestEnclosed && distance < bestDistance))
+                    {
+                        best         = t;
+                        bestNew      = newVertices;
+                        bestEnclosed = enclosed;
+                        bestDistance = distance;
+                    }
+                }
+                if (best < 0) {
+                    break;
+                }
+                add(best);
+            }
+        };
+
+        for (int seedCursor = 0;;) {
+            // continue next to the previous meshlet to keep meshlets of a group close together
+            int seed = findSeed(frontier);
+            if (seed < 0) {
+                while (seedCursor < triangleCount && meshletOf[seedCursor] >= 0) {
+                    ++seedCursor;
+                }
+                if (seedCursor == triangleCount) {
+                    break;
+                }
+                seed = seedCursor;
+            }
+            meshlets.emplace_back();
+            grow(static_cast<int>(meshlets.size()) - 1, seed, maxTriangles);
+        }
+
+        const auto vertexCount = [&](const std::vector<int>& a, const std::vector<int>& b) {
+            std::unordered_set<int> vertices;
+            for (const auto* meshlet : {&a, &b}) {
+                for (const int t : *meshlet) {
+                    vertices.insert(triangles.begin() + 3 * t, triangles.begin() + 3 * t + 3);
+                }
+            }
+            return static_cast<int>(vertices.size());
+        };
+
+        // fragments are too small to be worth a meshlet of their own, smallest first
+        const int        minTriangles = std::max(1, maxTriangles / 4);
+        std::vector<int> order(meshlets.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return meshlets[a].size() < meshlets[b].size();
+        });
+        for (const int fragment : order) {
+            const int size = static_cast<int>(meshlets[fragment].size());
+            if (size == 0 || size >= minTriangles) {
+                continue;
+            }
+
+            std::unordered_set<int> fragmentVertices;
+            for (const int t : meshlets[fragment]) {
+                fragmentVertices.insert(triangles.begin() + 3 * t, triangles.begin() + 3 * t + 3);
+            }
+            std::unordered_map<int, int> sharedVertices;
+            for (const int v : fragmentVertices) {
+                std::unordered_set<int> neighbors;
+                for (const int t : vertexTriangles[v]) {
+                    neighbors.insert(meshletOf[t]);
+                }
+                neighbors.erase(fragment);
+                for (const int neighbor : neighbors) {
+                    ++sharedVertices[neighbor];
+                }
+            }
+
+            // prefer the neighbor sharing the most vertices that has room for the whole fragment
+            int  best       = -1;
+            int  bestShared = 0;
+            bool bestFits   = false;
+            for (const auto& [neighbor, shared] : sharedVertices) {
+                const bool fits = static_cast<int>(meshlets[neighbor].size()) + size <= maxTriangles &&
+                                  vertexCount(meshlets[neighbor], meshlets[fragment]) <= maxVertices;
+                if (std::make_tuple(fits, shared, -neighbor) > std::make_tuple(bestFits, bestShared, -best)) {
+                    best       = neighbor;
+                    bestShared = shared;
+                    bestFits   = fits;
+                }
+            }
+            if (best < 0) {
+                continue;
+            }
+            if (bestFits) {
+                for (const int t : meshlets[fragment]) {
+                    meshletOf[t] = best;
+                    meshlets[best].emplace_back(t);
+                }
+                meshlets[fragment].clear();
+                continue;
+            }
+
+            // the neighbors are full, so the fragment and its neighbor are regrown as two meshlets of even size
+            std::vector<int> pool = std::move(meshlets[best]);
+            pool.insert(pool.end(), meshlets[fragment].begin(), meshlets[fragment].end());
+            for (const int t : pool) {
+                meshletOf[t] = -1;
+            }
+            meshlets[best].clear();
+            meshlets[fragment].clear();
+
+            int limit = (static_cast<int>(pool.size()) + 1) / 2;
+            for (int meshlet : {best, fragment}) {
+                const int seed = findSeed(pool);
+                if (seed >= 0) {
+                    grow(meshlet, seed, limit);
+                    limit = maxTriangles;
+                }
+            }
+            // disconnected leftovers of the pool
+            for (int seed = findSeed(pool); seed >= 0; seed = findSeed(pool)) {
+                meshlets.emplace_back();
+                grow(static_cast<int>(meshlets.size()) - 1, seed, maxTriangles);
+            }
+        }
+
+        std::vector<std::vector<int>> result;
+        for (const auto& meshlet : meshlets) {
+            if (meshlet.empty()) {
+                continue;
+            }
+            std::vector<int>& indices = result.emplace_back();
+            indices.reserve(3 * meshlet.size());
+            for (const int t : meshlet) {
+                indices.insert(indices.end(), triangles.begin() + 3 * t, triangles.begin() + 3 * t + 3);
+            }
+        }
+        return result;
+    }
+
+    // Computes optimal strips and encodes them. Splits the meshlet if the restarts between strips do not fit.
+    std::vector<Meshlet> SolveMeshlet(std::span<const float>  positions,
+                                      const std::vector<int>& triangles,
+                                      const BuildOptions&     options,
+                                      milp::MILPSolverBase&   solver)
+    {
+        const auto strips = gts::CreateMeshletStrips(triangles, options.stripOptions, solver);
+
+        if (gts::EncodedPrimitiveCount(triangles, strips) > gts::kMaxMeshletTriangles) {
+            const int            half = static_cast<int>(triangles.size() / 3 + 1) / 2;
+            std::vector<Meshlet> result;
+            for (const auto& part : BuildMeshlets(positions, triangles, half, options.maxVertices)) {
+                for (auto& meshlet : SolveMeshlet(positions, part, options, solver)) {
+                    result.emplace_back(std::move(meshlet));
+                }
+            }
+            return result;
+        }
+
+        Meshlet meshlet;
+        meshlet.triangles = triangles;
+        meshlet.encoded   = gts::EncodeMeshlet(triangles, strips);
+        meshlet.bounds    = ComputeBounds(positions, triangles);
+        meshlet.lodBounds = meshlet.bounds;
+        return {std::move(meshlet)};
+    }
+
+    // symmetric 4x4 matrix of the squared distance to a set of planes
+    struct Quadric {
+        std::array<double, 10> m = {};
+
+        static Quadric FromPlane(const Position& n, float d)
+        {
+            Quadric q;
+            q.m = {n[0] * n[0], n[0] * n[1], n[0] * n[2], n[0] * d, n[1] * n[1], n[1] * n[2], n[1] * d, n[2] * n[2],
+                   n[2] * d,    d * d};
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            for (int i = 0; i < 10; ++i) {
+                m[i] += other.m[i];
+            }
+            return *this;
+        }
+
+        double Evaluate(const Position& p) const
+        {
+            const double x = p[0];
+            const double y = p[1];
+            const double z = p[2];
+            return m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x + m[4] * y * y + 2 * m[5] * y * z +
+                   2 * m[6] * y + m[7] * z * z + 2 * m[8] * z + m[9];
+        }
+    };
+
+    // Quadric error half-edge collapse. Vertices never move, so every level indexes the input positions.
+    // Vertices on the group boundary are locked, keeping the group's border identical to its neighbors.
+    class Simplifier {
+    private:
+        std::span<const float>          positions_;
+        std::vector<int>                globalVertex_;
+        std::vector<std::array<int, 3>> triangles_;
+        std::vector<bool>               alive_;
+        std::vector<std::vector<int>>   vertexTriangles_;
+        std::vector<bool>               locked_;
+        std::vector<Quadric>            quadrics_;
+
+    public:
+        Simplifier(std::span<const float> positions, std::span<const int> triangles) : positions_(positions)
+        {
+            std::unordered_map<int, int> localVertex;
+            for (std::size_t t = 0; t < triangles.size() / 3; ++t) {
+                std::array<int, 3> triangle;
+                for (int corner = 0; corner < 3; ++corner) {
+                    const int v                = triangles[3 * t + corner];
+                    const auto& [it, inserted] = localVertex.emplace(v, static_cast<int>(globalVertex_.size()));
+                    if (inserted) {
+                        globalVertex_.emplace_back(v);
+                    }
+                    triangle[corner] = it->second;
+                }
+                triangles_.emplace_back(triangle);
+            }
+            alive_.assign(triangles_.size(), true);
+            vertexTriangles_.resize(globalVertex_.size());
+            locked_.assign(globalVertex_.size(), false);
+            quadrics_.resize(globalVertex_.size());
+
+            std::unordered_map<Edge, int, EdgeHash> edgeCount;
+            for (int t = 0; t < static_cast<int>(triangles_.size()); ++t) {
+                const auto& triangle = triangles_[t];
+                const auto  p0       = Local(triangle[0]);
+                const auto  normal   = Cross(Local(triangle[1]) - p0, Local(triangle[2]) - p0);
+                const float length   = Length(normal);
+
+                for (int corner = 0; corner < 3; ++corner) {
+                    const int v = triangle[corner];
+                    vertexTriangles_[v].emplace_back(t);
+                    ++edgeCount[std::minmax(v, triangle[(corner + 1) % 3])];
+                    if (length > 0.f) {
+                        const Position n = {normal[0] / length, normal[1] / length, normal[2] / length};
+                        quadrics_[v] += Quadric::FromPlane(n, -Dot(n, p0));
+                    }
+                }
+            }
+
+            // open and non-manifold edges are group boundaries
+            for (const auto& [edge, count] : edgeCount) {
+                if (count != 2) {
+                    locked_[edge.first]  = true;
+                    locked_[edge.second] = true;
+                }
+            }
+        }
+
+        // returns the error as distance to the surface of the triangles passed to the constructor
+        float operator()(int targetTriangleCount)
+        {
+            int    triangleCount = static_cast<int>(triangles_.size());
+            double maxCost       = 0.;
+
+            struct Collapse {
+                int    from;
+                int    to;
+                double cost;
+            };
+
+            while (triangleCount > targetTriangleCount) {
+                std::vector<Collapse> collapses;
+                for (int t = 0; t < static_cast<int>(triangles_.size()); ++t) {
+                    if (!alive_[t]) {
+                        continue;
+                    }
+                    for (int corner = 0; corner < 3; ++corner) {
+                        const int a = triangles_[t][corner];
+                        const int b = triangles_[t][(corner + 1) % 3];
+                        // interior edges are visited once per direction
+                        if (a > b) {
+                            continue;
+                        }
+                        Collapse best = {-1, -1, std::numeric_limits<double>::max()};
+                        for (const auto& [from, to] : {Edge{a, b}, Edge{b, a}}) {
+                            if (locked_[from]) {
+                                continue;
+                            }
+                            Quadric q = quadrics_[from];
+                            q += quadrics_[to];
+                            const double cost = q.Evaluate(Local(to));
+                            if (cost < best.cost) {
+                                best = {from, to, cost};
+                            }
+                        }
+                        if (best.from >= 0) {
+                            collapses.emplace_back(best);
+                        }
+                    }
+                }
+                std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+                    return a.cost < b.cost;
+                });
+
+                // collapses touching a vertex modified in this pass use outdated costs and are deferred
+                std::vector<bool> touched(globalVertex_.size(), false);
+                int               collapsed = 0;
+                for (const auto& collapse : collapses) {
+                    if (triangleCount <= targetTriangleCount) {
+                        break;
+                    }
+                    if (touched[collapse.from] || touched[collapse.to] || !CanCollapse(collapse.from, collapse.to)) {
+                        continue;
+                    }
+                    triangleCount -= Apply(collapse.from, collapse.to);
+                    touched[collapse.from] = true;
+                    touched[collapse.to]   = true;
+                    maxCost                = std::max(maxCost, collapse.cost);
+                    ++collapsed;
+                }
+                if (collapsed == 0) {
+                    break;
+                }
+            }
+            return static_cast<float>(std::sqrt(std::max(maxCost, 0.)));
+        }
+
+        std::vector<int> GetTriangles() const
+        {
+            std::vector<int> result;
+            for (std::size_t t = 0; t < triangles_.size(); ++t) {
+                if (alive_[t]) {
+                    for (const int v : triangles_[t]) {
+                        result.emplace_back(globalVertex_[v]);
+                    }
+                }
+            }
+            return result;
+        }
+
+    private:
+        Position Local(int v) const
+        {
+            return GetPosition(positions_, globalVertex_[v]);
+        }
+
+        bool CanCollapse(int from, int to) const
+        {
+            // link condition: the only common neighbors are the opposite vertices of the collapsed edge
+            std::unordered_set<int> neighbors;
+            int                     sharedTriangles = 0;
+            for (const int t : vertexTriangles_[from]) {
+                if (!alive_[t]) {
+                    continue;
+                }
+                const auto& triangle = triangles_[t];
+                if (std::find(triangle.begin(), triangle.end(), to) != triangle.end()) {
+                    ++sharedTriangles;
+                }
+                neighbors.insert(triangle.begin(), triangle.end());
+            }
+            std::unordered_set<int> common;
+            for (const int t : vertexTriangles_[to]) {
+                if (!alive_[t]) {
+                    continue;
+                }
+                for (const int v : triangles_[t]) {
+                    if (v != from && v != to && neighbors.contains(v)) {
+                        common.insert(v);
+                    }
+                }
+            }
+            if (static_cast<int>(common.size()) != sharedTriangles) {
+                return false;
+            }
+
+            // an edge between two locked vertices could also be created by the neighboring group
+            if (locked_[to]) {
+                for (const int v : neighbors) {
+                    if (v != from && v != to && locked_[v] && !common.contains(v)) {
+                        return false;
+                    }
+                }
+            }
+
+            // reject collapses that flip or degenerate the remaining triangles
+            for (const int t : vertexTriangles_[from]) {
+                if (!alive_[t]) {
+                    continue;
+                }
+                auto triangle = triangles_[t];
+                if (std::find(triangle.begin(), triangle.end(), to) != triangle.end()) {
+                    continue;
+                }
+                const auto before = Normal(triangle);
+                std::replace(triangle.begin(), triangle.end(), from, to);
+                const auto after = Normal(triangle);
+                if (Dot(before, after) <= 0.f) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        Position Normal(const std::array<int, 3>& triangle) const
+        {
+            const auto p0 = Local(triangle[0]);
+            return Cross(Local(triangle[1]) - p0, Local(triangle[2]) - p0);
+        }
+
+        // returns the number of removed triangles
+        int Apply(int from, int to)
+        {
+            int removed = 0;
+            for (const int t : vertexTriangles_[from]) {
+                if (!alive_[t]) {
+                    continue;
+                }
+                auto& triangle = triangles_[t];
+                if (std::find(triangle.begin(), triangle.end(), to) != triangle.end()) {
+                    alive_[t] = false;
+                    ++removed;
+                } else {
+                    std::replace(triangle.begin(), triangle.end(), from, to);
+                    vertexTriangles_[to].emplace_back(t);
+                }
+            }
+            vertexTriangles_[from].clear();
+            quadrics_[to] += quadrics_[from];
+            return removed;
+        }
+    };
+
+    // Greedily groups meshlets with the most shared vertices
+    std::vector<std::vector<int>> GroupMeshlets(const std::vector<Meshlet>& meshlets,
+                                                const std::vector<int>&     current,
+                                                int                         groupSize)
+    {
+        const int count = static_cast<int>(current.size());
+
+        std::unordered_map<int, std::vector<int>> vertexMeshlets;
+        for (int i = 0; i < count; ++i) {
+            const auto&             triangles = meshlets[current[i]].triangles;
+            std::unordered_set<int> vertices(triangles.begin(), triangles.end());
+            for (const int v : vertices) {
+                vertexMeshlets[v].emplace_back(i);
+            }
+        }
+
+        std::vector<std::unordered_map<int, int>> sharedVertices(count);
+        for (const auto& [v, list] : vertexMeshlets) {
+            for (std::size_t a = 0; a < list.size(); ++a) {
+                for (std::size_t b = a + 1; b < list.size(); ++b) {
+                    ++sharedVertices[list[a]][list[b]];
+                    ++sharedVertices[list[b]][list[a]];
+                }
+            }
+        }
+
+        std::vector<std::vector<int>> groups;
+        std::vector<bool>             grouped(count, false);
+        for (int seed = 0; seed < count; ++seed) {
+            if (grouped[seed]) {
+                continue;
+            }
+            std::vector<int>             group = {seed};
+            std::unordered_map<int, int> candidates(sharedVertices[seed]);
+            grouped[seed] = true;
+
+            while (static_cast<int>(group.size()) < groupSize) {
+                int best       = -1;
+                int bestShared = 0;
+                for (const auto& [candidate, shared] : candidates) {
+                    if (!grouped[candidate] &&
+                        (shared > bestShared || (shared == bestShared && candidate < best)))
+                    {
+                        best       = candidate;
+                        bestShared = shared;
+                    }
+                }
+                if (best < 0) {
+                    break;
+                }
+                grouped[best] = true;
+                group.emplace_back(best);
+                for (const auto& [neighbor, shared] : sharedVertices[best]) {
+                    candidates[neighbor] += shared;
+                }
+            }
+
+            groups.emplace_back(std::move(group));
+        }
+
+        // A meshlet left without ungrouped neighbors has its whole border locked and could never be simplified on its
+        // own, so it joins the group of the neighbor sharing the most vertices instead
+        std::vector<int> groupOf(count);
+        for (int g = 0; g < static_cast<int>(groups.size()); ++g) {
+            for (const int i : groups[g]) {
+                groupOf[i] = g;
+            }
+        }
+        for (int g = 0; g < static_cast<int>(groups.size()); ++g) {
+            if (groups[g].size() != 1) {
+                continue;
+            }
+            int best       = -1;
+            int bestShared = 0;
+            for (const auto& [neighbor, shared] : sharedVertices[groups[g][0]]) {
+                if (groupOf[neighbor] != g && (shared > bestShared || (shared == bestShared && neighbor < best))) {
+                    best       = neighbor;
+                    bestShared = shared;
+                }
+            }
+            if (best >= 0) {
+                groups[groupOf[best]].emplace_back(groups[g][0]);
+                groupOf[groups[g][0]] = groupOf[best];
+                groups[g].clear();
+            }
+        }
+        std::erase_if(groups, [](const std::vector<int>& group) { return group.empty(); });
+
+        for (auto& group : groups) {
+            for (int& i : group) {
+                i = current[i];
+            }
+        }
+        return groups;
+    }
+
+    ClusterDAG BuildClusterDAG(std::span<const float> positions,
+                               std::span<const int>   indices,
+                               const BuildOptions&    options)
+    {
+        if (indices.size() % 3 != 0) {
+            throw std::invalid_argument("Index count is not a multiple of 3");
+        }
+        if (positions.size() % 3 != 0) {
+            throw std::invalid_argument("Position count is not a multiple of 3");
+        }
+        const auto vertexCount = static_cast<std::int64_t>(positions.size() / 3);
+        for (const int index : indices) {
+            if (index < 0 || index >= vertexCount) {
+                throw std::invalid_argument("Vertex index " + std::to_string(index) + " is out of range");
+            }
+        }
+        if (options.maxTriangles < 1 || options.maxTriangles > gts::kMaxMeshletTriangles) {
+            throw std::invalid_argument("maxTriangles must be in [1, " + std::to_string(gts::kMaxMeshletTriangles) +
+                                        "]");
+        }
+        if (options.maxVertices < 3 || options.maxVertices > gts::kMaxMeshletVertices) {
+            throw std::invalid_argument("maxVertices must be in [3, " + std::to_string(gts::kMaxMeshletVertices) + "]");
+        }
+
+        // degenerate triangles are invisible and cannot be encoded
+        std::vector<int> triangles;
+        triangles.reserve(indices.size());
+        for (std::size_t i = 0; i < indices.size(); i += 3) {
+            const auto triangle = indices.subspan(i, 3);
+            if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[2] != triangle[0]) {
+                triangles.insert(triangles.end(), triangle.begin(), triangle.end());
+            }
+        }
+
+        ClusterDAG dag;
+
+        // every worker keeps its solver for the whole build, as creating one can be expensive, e.g. a Gurobi license
+        std::vector<std::unique_ptr<milp::MILPSolverBase>> solvers(GetThreadCount(options.threadCount));
+        const auto getSolver = [&](int worker) -> milp::MILPSolverBase& {
+            if (!solvers[worker]) {
+                solvers[worker] = optimal_strips::CreateSolver();
+            }
+            return *solvers[worker];
+        };
+
+        const auto parts = BuildMeshlets(positions, triangles, options.maxTriangles, options.maxVertices);
+        std::vector<std::vector<Meshlet>> solved(parts.size());
+        ParallelFor(static_cast<int>(parts.size()), options.threadCount, [&](int i, int worker) {
+            solved[i] = SolveMeshlet(positions, parts[i], options, getSolver(worker));
+        });
+
+        std::vector<int> current;
+        for (auto& meshlets : solved) {
+            for (auto& meshlet : meshlets) {
+                current.emplace_back(static_cast<int>(dag.meshlets.size()));
+                dag.meshlets.emplace_back(std::move(meshlet));
+            }
+        }
+        dag.levelCount = dag.meshlets.empty() ? 0 : 1;
+
+        while (current.size() > 1) {
+            const auto groups = GroupMeshlets(dag.meshlets, current, options.groupSize);
+
+            struct GroupResult {
+                bool                 simplified = false;
+                float                error      = 0.f;
+                std::vector<Meshlet> meshlets;
+            };
+            std::vector<GroupResult> results(groups.size());
+
+            ParallelFor(static_cast<int>(groups.size()), options.threadCount, [&](int g, int worker) {
+                std::vector<int> merged;
+                for (const int m : groups[g]) {
+                    const auto& triangles = dag.meshlets[m].triangles;
+                    merged.insert(merged.end(), triangles.begin(), triangles.end());
+                }
+                const int triangleCount = static_cast<int>(merged.size() / 3);
+
+                Simplifier  simplifier(positions, merged);
+                const float error      = simplifier(static_cast<int>(triangleCount * options.simplifyRatio));
+                const auto  simplified = simplifier.GetTriangles();
+
+                const int simplifiedCount = static_cast<int>(simplified.size() / 3);
+                if (simplifiedCount == 0 || simplifiedCount > triangleCount * options.minReduction) {
+                    return;
+                }
+
+                auto& result      = results[g];
+                result.simplified = true;
+                result.error      = error;
+                const auto parts  = BuildMeshlets(positions, simplified, options.maxTriangles, options.maxVertices);
+                for (const auto& part : parts) {
+                    for (auto& meshlet : SolveMeshlet(positions, part, options, getSolver(worker))) {
+                        result.meshlets.emplace_back(std::move(meshlet));
+                    }
+                }
+            });
+
+            std::vector<int> next;
+            bool             anySimplified = false;
+            for (std::size_t g = 0; g < groups.size(); ++g) {
+                auto& result = results[g];
+                if (!result.simplified) {
+                    // try again with different neighbors on the next level
+                    next.insert(next.end(), groups[g].begin(), groups[g].end());
+                    continue;
+                }
+
+                anySimplified        = true;
+                const int groupIndex = static_cast<int>(dag.groups.size());
+                Group&    group      = dag.groups.emplace_back();
+                group.level          = dag.levelCount - 1;
+                group.children       = groups[g];
+
+                // error and bounds must not be smaller than those of the children for a consistent cut
+                group.error  = result.error;
+                group.bounds = dag.meshlets[group.children[0]].lodBounds;
+                for (const int child : group.children) {
+                    group.error  = std::max(group.error, dag.meshlets[child].lodError);
+                    group.bounds = MergeSpheres(group.bounds, dag.meshlets[child].lodBounds);
+                }
+                for (const int child : group.children) {
+                    auto& meshlet        = dag.meshlets[child];
+                    meshlet.group        = groupIndex;
+                    meshlet.parentError  = group.error;
+                    meshlet.parentBounds = group.bounds;
+                }
+
+                for (auto& meshlet : result.meshlets) {
+                    meshlet.level       = dag.levelCount;
+                    meshlet.sourceGroup = groupIndex;
+                    meshlet.lodError    = group.error;
+                    meshlet.lodBounds   = group.bounds;
+                    group.parents.emplace_back(static_cast<int>(dag.meshlets.size()));
+                    next.emplace_back(static_cast<int>(dag.meshlets.size()));
+                    dag.meshlets.emplace_back(std::move(meshlet));
+                }
+            }
+
+            if (!anySimplified) {
+                // no group could be simplified any further
+                break;
+            }
+            ++dag.levelCount;
+            current = std::move(next);
+        }
+        return dag;
+    }
+
+    float ProjectedError(float error, const Sphere& bounds, const Position& viewPosition)
+    {
+        const float distance = Length(bounds.center - viewPosition) - bounds.radius;
+        return error / std::max(distance, std::numeric_limits<float>::min());
+    }
+
+    std::vector<int> SelectMeshlets(const ClusterDAG& dag, const Position& viewPosition, float errorThreshold)
+    {
+        std::vector<int> result;
+        for (int m = 0; m < static_cast<int>(dag.meshlets.size()); ++m) {
+            const auto& meshlet = dag.meshlets[m];
+            if (ProjectedError(meshlet.lodError, meshlet.lodBounds, viewPosition) <= errorThreshold &&
+                ProjectedError(meshlet.parentError, meshlet.parentBounds, viewPosition) > errorThreshold)
+            {
+                result.emplace_back(m);
+            }
+        }
+        return result;
+    }
+}  // namespace cluster_lod
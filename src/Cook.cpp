@@ -0,0 +1,341 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Cook.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace cook {
+    enum class MessageType : std::uint32_t { SUBMIT_JOB, MESHLET_RESULT, JOB_COMPLETE, JOB_ERROR };
+
+    struct MessageHeader {
+        std::uint32_t magic   = kProtocolMagic;
+        std::uint32_t version = kProtocolVersion;
+        MessageType   type    = MessageType::SUBMIT_JOB;
+        std::uint32_t size    = 0;
+    };
+
+    // guards against allocating arbitrary amounts of memory for a corrupt header
+    constexpr std::uint32_t kMaxPayloadSize = 1u << 30;
+
+    class PayloadWriter {
+    private:
+        std::vector<char> data_;
+
+    public:
+        template <typename T>
+        void Put(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const auto* bytes = reinterpret_cast<const char*>(&value);
+            data_.insert(data_.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <typename T>
+        void PutArray(std::span<const T> values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Put(static_cast<std::uint32_t>(values.size()));
+            const auto* bytes = reinterpret_cast<const char*>(values.data());
+            data_.insert(data_.end(), bytes, bytes + values.size_bytes());
+        }
+
+        const std::vector<char>& Data() const
+        {
+            return data_;
+        }
+    };
+
+    class PayloadReader {
+    private:
+        std::span<const char> data_;
+
+        std::span<const char> Take(std::size_t size)
+        {
+            if (size > data_.size()) {
+                throw std::runtime_error("Truncated cook message");
+            }
+            const auto result = data_.first(size);
+            data_             = data_.subspan(size);
+            return result;
+        }
+
+    public:
+        explicit PayloadReader(std::span<const char> data) : data_(data) {}
+
+        template <typename T>
+        T Get()
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value;
+            std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        std::vector<T> GetArray()
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const auto     count = Get<std::uint32_t>();
+            const auto     bytes = Take(std::size_t(count) * sizeof(T));
+            std::vector<T> values(count);
+            std::memcpy(values.data(), bytes.data(), bytes.size());
+            return values;
+        }
+
+        void Finish() const
+        {
+            if (!data_.empty()) {
+                throw std::runtime_error("Trailing bytes in cook message");
+            }
+        }
+    };
+
+    // Writing to a disconnected peer fails with EPIPE instead of raising SIGPIPE, which would terminate any process
+    // using the library that does not ignore the signal itself
+    void WriteAll(int fd, const char* data, std::size_t size)
+    {
+#ifndef MSG_NOSIGNAL
+        // e.g. macOS, which only offers the socket option
+        const int noSigPipe = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+        while (size > 0) {
+#ifdef MSG_NOSIGNAL
+            const auto written = send(fd, data, size, MSG_NOSIGNAL);
+#else
+            const auto written = send(fd, data, size, 0);
+#endif
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("Cook socket write failed: ") + std::strerror(errno));
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
+
+    // Returns false if the peer closed the connection before the first byte
+    bool ReadAll(int fd, char* data, std::size_t size)
+    {
+        std::size_t total = 0;
+        while (total < size) {
+            const auto count = read(fd, data + total, size - total);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("Cook socket read failed: ") + std::strerror(errno));
+            }
+            if (count == 0) {
+                if (total == 0) {
+                    return false;
+                }
+                throw std::runtime_error("Cook connection closed within a message");
+            }
+            total += static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+
+    void WriteMessage(int fd, MessageType type, const PayloadWriter& payload)
+    {
+        MessageHeader header;
+        header.type = type;
+        header.size = static_cast<std::uint32_t>(payload.Data().size());
+
+        // a single write keeps small messages in one packet
+        std::vector<char> message(sizeof(header));
+        std::memcpy(message.data(), &header, sizeof(header));
+        message.insert(message.end(), payload.Data().begin(), payload.Data().end());
+        WriteAll(fd, message.data(), message.size());
+    }
+
+    std::optional<std::pair<MessageType, std::vector<char>>> ReadMessage(int fd)
+    {
+        MessageHeader header;
+        if (!ReadAll(fd, reinterpret_cast<char*>(&header), sizeof(header))) {
+            return std::nullopt;
+        }
+        if (header.magic != kProtocolMagic || header.version != kProtocolVersion) {
+            throw std::runtime_error("Cook protocol mismatch");
+        }
+        if (header.size > kMaxPayloadSize) {
+            throw std::runtime_error("Cook message too large");
+        }
+        std::vector<char> payload(header.size);
+        if (header.size > 0 && !ReadAll(fd, payload.data(), payload.size())) {
+            throw std::runtime_error("Cook connection closed within a message");
+        }
+        return std::make_pair(header.type, std::move(payload));
+    }
+
+    std::string DefaultSocketPath()
+    {
+        if (const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR"); runtimeDir != nullptr && *runtimeDir != '\0') {
+            return std::string(runtimeDir) + "/optimal-strips-cook.sock";
+        }
+        return "/tmp/optimal-strips-cook-" + std::to_string(getuid()) + ".sock";
+    }
+
+    void WriteJob(int fd, const Job& job)
+    {
+        PayloadWriter payload;
+        payload.Put(job.id);
+        payload.Put(job.priority);
+        payload.Put(job.kind);
+        payload.Put(static_cast<std::uint8_t>(job.bridgedStrips));
+        payload.PutArray<float>(job.positions);
+        payload.PutArray<int>(job.indices);
+        WriteMessage(fd, MessageType::SUBMIT_JOB, payload);
+    }
+
+    std::optional<Job> ReadJob(int fd)
+    {
+        auto message = ReadMessage(fd);
+        if (!message) {
+            return std::nullopt;
+        }
+        if (message->first != MessageType::SUBMIT_JOB) {
+            throw std::runtime_error("Unexpected cook message");
+        }
+
+        PayloadReader payload(message->second);
+        Job           job;
+        job.id            = payload.Get<std::uint64_t>();
+        job.priority      = payload.Get<Priority>();
+        job.kind          = payload.Get<JobKind>();
+        job.bridgedStrips = payload.Get<std::uint8_t>() != 0;
+        job.positions     = payload.GetArray<float>();
+        job.indices       = payload.GetArray<int>();
+        payload.Finish();
+
+        if (job.priority != Priority::INTERACTIVE && job.priority != Priority::BATCH) {
+            throw std::runtime_error("Invalid cook job priority");
+        }
+        if (job.kind != JobKind::MESHLET && job.kind != JobKind::MESH) {
+            throw std::runtime_error("Invalid cook job kind");
+        }
+        return job;
+    }
+
+    void WriteResponse(int fd, const Response& response)
+    {
+        PayloadWriter payload;
+        if (const auto* result = std::get_if<MeshletResult>(&response)) {
+            payload.Put(result->jobId);
+            payload.Put(static_cast<std::uint8_t>(result->cached));
+            payload.PutArray<int>(result->triangles);
+            payload.PutArray<int>(result->encoded.vertices);
+            payload.Put(result->encoded.primitiveCount);
+            payload.PutArray<std::uint32_t>(result->encoded.data);
+            WriteMessage(fd, MessageType::MESHLET_RESULT, payload);
+        } else if (const auto* complete = std::get_if<JobComplete>(&response)) {
+            payload.Put(complete->jobId);
+            payload.Put(complete->meshletCount);
+            WriteMessage(fd, MessageType::JOB_COMPLETE, payload);
+        } else {
+            const auto& error = std::get<JobError>(response);
+            payload.Put(error.jobId);
+            payload.PutArray<char>(error.message);
+            WriteMessage(fd, MessageType::JOB_ERROR, payload);
+        }
+    }
+
+    std::optional<Response> ReadResponse(int fd)
+    {
+        auto message = ReadMessage(fd);
+        if (!message) {
+            return std::nullopt;
+        }
+
+        PayloadReader payload(message->second);
+        Response      response;
+        switch (message->first) {
+        case MessageType::MESHLET_RESULT: {
+            MeshletResult result;
+            result.jobId                  = payload.Get<std::uint64_t>();
+            result.cached                 = payload.Get<std::uint8_t>() != 0;
+            result.triangles              = payload.GetArray<int>();
+            result.encoded.vertices       = payload.GetArray<int>();
+            result.encoded.primitiveCount = payload.Get<std::uint32_t>();
+            result.encoded.data           = payload.GetArray<std::uint32_t>();
+            response                      = std::move(result);
+            break;
+        }
+        case MessageType::JOB_COMPLETE: {
+            JobComplete complete;
+            complete.jobId        = payload.Get<std::uint64_t>();
+            complete.meshletCount = payload.Get<std::uint32_t>();
+            response              = complete;
+            break;
+        }
+        case MessageType::JOB_ERROR: {
+            JobError   error;
+            error.jobId     = payload.Get<std::uint64_t>();
+            const auto text = payload.GetArray<char>();
+            error.message.assign(text.begin(), text.end());
+            response = std::move(error);
+            break;
+        }
+        default:
+            throw std::runtime_error("Unexpected cook message");
+        }
+        payload.Finish();
+        return response;
+    }
+
+    Client::Client(const std::string& socketPath)
+    {
+        sockaddr_un address = {};
+        address.sun_family  = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Cook socket path too long: " + socketPath);
+        }
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+        fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0) {
+            throw std::runtime_error(std::string("Cannot create cook socket: ") + std::strerror(errno));
+        }
+        if (connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            const int error = errno;
+            close(fd_);
+            throw std::runtime_error("Cannot connect to cook daemon at " + socketPath + ": " + std::strerror(error));
+        }
+    }
+
+    Client::~Client()
+    {
+        close(fd_);
+    }
+
+    std::uint64_t Client::Submit(Job job)
+    {
+        job.id = nextJobId_++;
+        WriteJob(fd_, job);
+        return job.id;
+    }
+
+    std::optional<Response> Client::Receive()
+    {
+        return ReadResponse(fd_);
+    }
+}  // namespace cook
@@ -0,0 +1,564 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "CookServer.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ClusterLOD.h"
+
+namespace cook {
+    // a client that does not read its results for this long is disconnected instead of blocking a worker
+    constexpr int kSendTimeoutSeconds = 10;
+
+    std::runtime_error SystemError(const std::string& what)
+    {
+        return std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    class Connection {
+    private:
+        const int         fd_;
+        std::mutex        writeMutex_;
+        std::atomic<bool> closed_   = false;
+        std::atomic<bool> finished_ = false;
+        std::thread       thread_;
+
+    public:
+        explicit Connection(int fd) : fd_(fd)
+        {
+            const timeval timeout = {kSendTimeoutSeconds, 0};
+            setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        }
+
+        ~Connection()
+        {
+            close(fd_);
+        }
+
+        int Fd() const
+        {
+            return fd_;
+        }
+
+        bool IsClosed() const
+        {
+            return closed_;
+        }
+
+        bool IsFinished() const
+        {
+            return finished_;
+        }
+
+        template <typename Function>
+        void Start(Function&& fn)
+        {
+            thread_ = std::thread([this, fn = std::forward<Function>(fn)]() {
+                fn();
+                finished_ = true;
+            });
+        }
+
+        void Join()
+        {
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+        }
+
+        // Unblocks the reading thread. The descriptor stays valid until all jobs of the connection are done.
+        void Close()
+        {
+            closed_ = true;
+            shutdown(fd_, SHUT_RDWR);
+        }
+
+        // Responses of concurrent workers are serialized. Write errors close the connection.
+        void Send(const Response& response)
+        {
+            std::lock_guard lock(writeMutex_);
+            if (closed_) {
+                return;
+            }
+            try {
+                WriteResponse(fd_, response);
+            } catch (const std::runtime_error&) {
+                Close();
+            }
+        }
+    };
+
+    // Least recently used encoded meshlets. The encoding only depends on the triangles and the strip options.
+    class ResultCache {
+    private:
+        struct Entry {
+            std::uint64_t                key;
+            std::vector<int>             triangles;
+            optimal_strips::StripOptions options;
+            gts::EncodedMeshlet          encoded;
+        };
+
+        std::mutex                                                    mutex_;
+        const std::size_t                                             capacity_;
+        std::list<Entry>                                              entries_;
+        std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index_;
+
+        static bool SameOptions(const optimal_strips::StripOptions& a, const optimal_strips::StripOptions& b)
+        {
+            return a.allowBridges == b.allowBridges && a.restartCost == b.restartCost && a.bridgeCost == b.bridgeCost;
+        }
+
+        // FNV-1a
+        static std::uint64_t Hash(std::span<const int> triangles, const optimal_strips::StripOptions& options)
+        {
+            std::uint64_t hash = 14695981039346656037ull;
+            const auto    add  = [&](const void* data, std::size_t size) {
+                for (std::size_t i = 0; i < size; ++i) {
+                    hash = (hash ^ static_cast<const unsigned char*>(data)[i]) * 1099511628211ull;
+                }
+            };
+            add(&options.allowBridges, sizeof(options.allowBridges));
+            add(&options.restartCost, sizeof(options.restartCost));
+            add(&options.bridgeCost, sizeof(options.bridgeCost));
+            add(triangles.data(), triangles.size_bytes());
+            return hash;
+        }
+
+    public:
+        explicit ResultCache(std::size_t capacity) : capacity_(capacity) {}
+
+        std::optional<gts::EncodedMeshlet> Find(const std::vector<int>&             triangles,
+                                                const optimal_strips::StripOptions& options)
+        {
+            const auto      key = Hash(triangles, options);
+            std::lock_guard lock(mutex_);
+            const auto      it = index_.find(key);
+            if (it == index_.end() || it->second->triangles != triangles ||
+                !SameOptions(it->second->options, options))
+            {
+                return std::nullopt;
+            }
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return it->second->encoded;
+        }
+
+        void Insert(const std::vector<int>&             triangles,
+                    const optimal_strips::StripOptions& options,
+                    const gts::EncodedMeshlet&          encoded)
+        {
+            if (capacity_ == 0) {
+                return;
+            }
+            const auto      key = Hash(triangles, options);
+            std::lock_guard lock(mutex_);
+            if (const auto it = index_.find(key); it != index_.end()) {
+                // replaces a hash collision or a meshlet solved concurrently by another worker
+                entries_.erase(it->second);
+                index_.erase(it);
+            }
+            entries_.push_front({key, triangles, options, encoded});
+            index_[key] = entries_.begin();
+            if (entries_.size() > capacity_) {
+                index_.erase(entries_.back().key);
+                entries_.pop_back();
+            }
+        }
+    };
+
+    struct JobState {
+        std::shared_ptr<Connection>  connection;
+        std::uint64_t                id       = 0;
+        Priority                     priority = Priority::BATCH;
+        optimal_strips::StripOptions options;
+        // used to split meshlets, may be empty
+        std::vector<float>           positions;
+        std::atomic<std::size_t>     pendingTasks = 0;
+        std::atomic<std::uint32_t>   meshletCount = 0;
+        std::atomic<bool>            failed       = false;
+    };
+
+    struct Task {
+        std::shared_ptr<JobState> job;
+        std::vector<int>          triangles;
+        // splits the triangles of a mesh job into meshlet tasks instead of solving them
+        bool splitMesh = false;
+    };
+
+    // FIFO per priority class. Interactive tasks are always taken before batch tasks.
+    class TaskQueue {
+    private:
+        std::mutex                      mutex_;
+        std::condition_variable         condition_;
+        std::array<std::deque<Task>, 2> tasks_;
+        bool                            closed_ = false;
+
+    public:
+        void Push(Priority priority, Task&& task)
+        {
+            {
+                std::lock_guard lock(mutex_);
+                tasks_[static_cast<int>(priority)].emplace_back(std::move(task));
+            }
+            // notify_one could wake an interactive-only worker for a batch task
+            condition_.notify_all();
+        }
+
+        // Blocks until a task is available. Returns nullopt once the queue is closed, dropping the remaining tasks.
+        std::optional<Task> Pop(bool interactiveOnly)
+        {
+            std::unique_lock lock(mutex_);
+            condition_.wait(lock, [&] {
+                return closed_ || !tasks_[0].empty() || (!interactiveOnly && !tasks_[1].empty());
+            });
+            if (closed_) {
+                return std::nullopt;
+            }
+            auto& tasks = tasks_[0].empty() ? tasks_[1] : tasks_[0];
+            Task  task  = std::move(tasks.front());
+            tasks.pop_front();
+            return task;
+        }
+
+        void Close()
+        {
+            {
+                std::lock_guard lock(mutex_);
+                closed_ = true;
+            }
+            condition_.notify_all();
+        }
+    };
+
+    bool IsListening(const sockaddr_un& address)
+    {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+        const bool listening = connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+        close(fd);
+        return listening;
+    }
+
+    int CountVertices(std::span<const int> triangles)
+    {
+        return static_cast<int>(std::unordered_set<int>(triangles.begin(), triangles.end()).size());
+    }
+
+    Server::Server(ServerOptions options)
+        : options_(std::move(options)),
+          queue_(std::make_unique<TaskQueue>()),
+          cache_(std::make_unique<ResultCache>(options_.cacheCapacity))
+    {
+        sockaddr_un address = {};
+        address.sun_family  = AF_UNIX;
+        if (options_.socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Cook socket path too long: " + options_.socketPath);
+        }
+        std::memcpy(address.sun_path, options_.socketPath.c_str(), options_.socketPath.size() + 1);
+
+        // an existing socket file is only stale if nobody accepts connections on it
+        if (IsListening(address)) {
+            throw std::runtime_error("A cook daemon is already running at " + options_.socketPath);
+        }
+        unlink(options_.socketPath.c_str());
+
+        listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd_ < 0) {
+            throw SystemError("Cannot create cook socket");
+        }
+        if (bind(listenFd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            const auto error = SystemError("Cannot bind cook socket " + options_.socketPath);
+            close(listenFd_);
+            throw error;
+        }
+        // jobs and results are private to the user running the daemon
+        chmod(options_.socketPath.c_str(), S_IRUSR | S_IWUSR);
+        if (listen(listenFd_, SOMAXCONN) != 0 || pipe(wakeFds_) != 0) {
+            const auto error = SystemError("Cannot listen on cook socket " + options_.socketPath);
+            close(listenFd_);
+            unlink(options_.socketPath.c_str());
+            throw error;
+        }
+    }
+
+    Server::~Server()
+    {
+        close(wakeFds_[0]);
+        close(wakeFds_[1]);
+        close(listenFd_);
+        unlink(options_.socketPath.c_str());
+    }
+
+    void Server::Run()
+    {
+        if (!workers_.empty()) {
+            throw std::logic_error("Cook server is already running");
+        }
+
+        // create all solvers up front, so that missing licenses or libraries fail here and not in a worker
+        const int workerCount = options_.workerCount > 0
+                                    ? options_.workerCount
+                                    : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        std::vector<std::unique_ptr<milp::MILPSolverBase>> solvers;
+        for (int i = 0; i < workerCount; ++i) {
+            solvers.emplace_back(optimal_strips::CreateSolver());
+        }
+        const int interactiveWorkerCount = std::clamp(options_.interactiveWorkerCount, 0, workerCount - 1);
+        for (int i = 0; i < workerCount; ++i) {
+            workers_.emplace_back(
+                [this, solver = std::move(solvers[i]), interactiveOnly = i < interactiveWorkerCount]() {
+                    Work(*solver, interactiveOnly);
+                });
+        }
+
+        try {
+            Accept();
+        } catch (...) {
+            Shutdown();
+            throw;
+        }
+        Shutdown();
+    }
+
+    void Server::Stop()
+    {
+        // only async-signal-safe calls, so that Stop can be called from a signal handler
+        stopping_.store(true);
+        [[maybe_unused]] const auto written = write(wakeFds_[1], "", 1);
+    }
+
+    ServerStatistics Server::GetStatistics() const
+    {
+        return {
+            .jobs       = jobs_,
+            .failedJobs = failedJobs_,
+            .meshlets   = meshlets_,
+            .cacheHits  = cacheHits_,
+            .solves     = solves_,
+        };
+    }
+
+    void Server::Accept()
+    {
+        while (!stopping_) {
+            std::array<pollfd, 2> fds = {{{listenFd_, POLLIN, 0}, {wakeFds_[0], POLLIN, 0}}};
+            if (poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw SystemError("Cook socket poll failed");
+            }
+            if (fds[1].revents != 0) {
+                break;
+            }
+            if ((fds[0].revents & POLLIN) == 0) {
+                continue;
+            }
+
+            const int fd = accept(listenFd_, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN) {
+                    continue;
+                }
+                throw SystemError("Cook socket accept failed");
+            }
+
+            std::erase_if(connections_, [](const std::shared_ptr<Connection>& connection) {
+                if (!connection->IsFinished()) {
+                    return false;
+                }
+                connection->Join();
+                return true;
+            });
+
+            auto connection = std::make_shared<Connection>(fd);
+            connections_.emplace_back(connection);
+            connection->Start([this, connection]() { ServeConnection(connection); });
+        }
+    }
+
+    void Server::Shutdown()
+    {
+        queue_->Close();
+        for (const auto& connection : connections_) {
+            connection->Close();
+        }
+        for (const auto& connection : connections_) {
+            connection->Join();
+        }
+        connections_.clear();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+    }
+
+    void Server::ServeConnection(const std::shared_ptr<Connection>& connection)
+    {
+        try {
+            while (auto job = ReadJob(connection->Fd())) {
+                Submit(connection, std::move(*job));
+            }
+        } catch (const std::exception& e) {
+            // the message stream cannot be resynchronized after a malformed message
+            if (!connection->IsClosed()) {
+                std::cerr << "Closing cook connection: " << e.what() << std::endl;
+            }
+        }
+        connection->Close();
+    }
+
+    void Server::Submit(const std::shared_ptr<Connection>& connection, Job&& job)
+    {
+        ++jobs_;
+
+        auto state        = std::make_shared<JobState>();
+        state->connection = connection;
+        state->id         = job.id;
+        state->priority   = job.priority;
+        state->options    = job.bridgedStrips ? gts::kBridgedStripOptions : optimal_strips::StripOptions{};
+        state->positions  = std::move(job.positions);
+
+        const auto reject = [&](const std::string& message) {
+            ++failedJobs_;
+            connection->Send(JobError{job.id, message});
+        };
+        if (job.indices.size() % 3 != 0) {
+            reject("Index count is not a multiple of 3");
+            return;
+        }
+        if (state->positions.size() % 3 != 0) {
+            reject("Position count is not a multiple of 3");
+            return;
+        }
+        const int vertexCount = static_cast<int>(state->positions.size() / 3);
+        for (const int index : job.indices) {
+            if (index < 0 || (vertexCount > 0 && index >= vertexCount)) {
+                reject("Vertex index out of range");
+                return;
+            }
+        }
+        // would be encoded as visible triangles, see gts::EncodeMeshlet
+        for (std::size_t i = 0; i < job.indices.size(); i += 3) {
+            const int* triangle = &job.indices[i];
+            if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) {
+                reject("Triangle " + std::to_string(i / 3) + " is degenerate");
+                return;
+            }
+        }
+
+        if (job.indices.empty()) {
+            connection->Send(JobComplete{state->id, 0});
+            return;
+        }
+        // Splitting a large mesh takes a while, so it runs on a worker to keep this thread reading the jobs behind.
+        // Meshlet jobs are split by Solve only if they exceed the limits.
+        state->pendingTasks = 1;
+        queue_->Push(job.priority, {state, std::move(job.indices), job.kind == JobKind::MESH});
+    }
+
+    void Server::Split(const Task& task)
+    {
+        auto& job   = *task.job;
+        auto  parts = cluster_lod::BuildMeshlets(
+            job.positions, task.triangles, gts::kMaxMeshletTriangles, gts::kMaxMeshletVertices);
+        // counted before the split task itself completes, so that the job cannot complete early
+        job.pendingTasks += parts.size();
+        for (auto& part : parts) {
+            queue_->Push(job.priority, {task.job, std::move(part)});
+        }
+    }
+
+    void Server::Work(milp::MILPSolverBase& solver, bool interactiveOnly)
+    {
+        while (auto task = queue_->Pop(interactiveOnly)) {
+            auto& job = *task->job;
+            if (!job.connection->IsClosed() && !job.failed) {
+                try {
+                    if (task->splitMesh) {
+                        Split(*task);
+                    } else {
+                        Solve(*task, solver, task->triangles);
+                    }
+                } catch (const std::exception& e) {
+                    if (!job.failed.exchange(true)) {
+                        ++failedJobs_;
+                        job.connection->Send(JobError{job.id, e.what()});
+                    }
+                }
+            }
+            if (--job.pendingTasks == 0 && !job.failed) {
+                job.connection->Send(JobComplete{job.id, job.meshletCount});
+            }
+        }
+    }
+
+    void Server::Solve(const Task& task, milp::MILPSolverBase& solver, const std::vector<int>& triangles)
+    {
+        auto&      job  = *task.job;
+        const auto send = [&](const gts::EncodedMeshlet& encoded, bool cached) {
+            ++job.meshletCount;
+            ++meshlets_;
+            job.connection->Send(MeshletResult{job.id, cached, triangles, encoded});
+        };
+        const auto split = [&](int maxTriangles) {
+            const auto parts =
+                cluster_lod::BuildMeshlets(job.positions, triangles, maxTriangles, gts::kMaxMeshletVertices);
+            for (const auto& part : parts) {
+                Solve(task, solver, part);
+            }
+        };
+
+        if (const auto cached = cache_->Find(triangles, job.options)) {
+            ++cacheHits_;
+            send(*cached, true);
+            return;
+        }
+
+        const int triangleCount = static_cast<int>(triangles.size() / 3);
+        if (triangleCount > gts::kMaxMeshletTriangles || CountVertices(triangles) > gts::kMaxMeshletVertices) {
+            split(gts::kMaxMeshletTriangles);
+            return;
+        }
+
+        ++solves_;
+        const auto strips = gts::CreateMeshletStrips(triangles, job.options, solver);
+        if (gts::EncodedPrimitiveCount(triangles, strips) > gts::kMaxMeshletTriangles) {
+            // the degenerate triangles between strips do not fit, as in cluster_lod::BuildClusterDAG
+            split((triangleCount + 1) / 2);
+            return;
+        }
+
+        const auto encoded = gts::EncodeMeshlet(triangles, strips);
+        cache_->Insert(triangles, job.options, encoded);
+        send(encoded, false);
+    }
+}  // namespace cook
@@ -0,0 +1,390 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <GTS.h>
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace gts {
+    using Triangle = std::array<int, 3>;
+
+    // L = false, R = true. See LoadTriangleFlag in GTS.hlsl
+    constexpr bool kLeft  = false;
+    constexpr bool kRight = true;
+
+    bool IsSameTriangle(const Triangle& a, const Triangle& b)
+    {
+        // triangles are equal if they are a rotation of each other, i.e. have the same winding
+        for (int r = 0; r < 3; ++r) {
+            if (a[0] == b[r] && a[1] == b[(r + 1) % 3] && a[2] == b[(r + 2) % 3]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Tracks the decoder state while appending triangles to the generalized strip
+    class StripWriter {
+    private:
+        // vertices of triangle 0 that are not stored, i.e. triangleIndex < 0 in LoadTriangleIndex
+        std::array<int, 2> start_;
+        // new vertex and L/R flag of every triangle
+        std::vector<int>   indices_;
+        std::vector<bool>  flags_;
+
+    public:
+        bool Empty() const
+        {
+            return indices_.empty();
+        }
+
+        void Start(const Triangle& triangle, const Triangle* next)
+        {
+            const auto oriented = Orient(triangle, next);
+            start_              = {oriented[0], oriented[1]};
+            // triangle 0 always decodes to (0, 1, 2) for a left flag
+            Emit(oriented[2], kLeft);
+        }
+
+        // Appends the triangle behind as few degenerate triangles as possible and returns the number of emitted
+        // primitives, or 0 if more than maxLength would be needed. A triangle sharing an edge with the previous one
+        // needs no degenerate triangle, a triangle sharing a vertex kBridgeTriangles and any other kRestartTriangles.
+        int Connect(const Triangle& triangle, const Triangle* next, int maxLength = kRestartTriangles + 1)
+        {
+            // repeating the last vertex or vertices of the triangle suffices to build any bridge
+            const std::array<int, 4> candidates = {Index(Size() - 1), triangle[0], triangle[1], triangle[2]};
+            for (int length = 1; length <= maxLength; ++length) {
+                if (Search(triangle, next, candidates, length)) {
+                    return length;
+                }
+            }
+            return 0;
+        }
+
+        void Undo(int count)
+        {
+            indices_.resize(indices_.size() - count);
+            flags_.resize(flags_.size() - count);
+        }
+
+        int Size() const
+        {
+            return static_cast<int>(indices_.size());
+        }
+
+        EncodedMeshlet Finish() const
+        {
+            EncodedMeshlet result;
+            result.primitiveCount = Size();
+            if (Empty()) {
+                return result;
+            }
+            if (Size() > kMaxMeshletTriangles) {
+                throw std::length_error("Encoded meshlet exceeds the maximum number of triangles");
+            }
+
+            std::unordered_map<int, std::uint32_t> localIndex;
+
+            const auto toLocal = [&](int v) {
+                const auto [it, inserted] = localIndex.emplace(v, static_cast<std::uint32_t>(result.vertices.size()));
+                if (inserted) {
+                    result.vertices.emplace_back(v);
+                }
+                return it->second;
+            };
+            // first use order, so that triangle 0 references local vertices 0, 1 and 2
+            toLocal(start_[0]);
+            toLocal(start_[1]);
+
+            result.data.resize(kTriangleFlagDwords + (Size() + 3) / 4, 0u);
+            for (int t = 0; t < Size(); ++t) {
+                const auto local = toLocal(indices_[t]);
+                if (flags_[t]) {
+                    result.data[t / 32] |= 1u << (t % 32);
+                }
+                if (t > 0) {
+                    // triangle 0 does not store any vertex index
+                    result.data[kTriangleFlagDwords + (t - 1) / 4] |= local << (((t - 1) % 4) * 8);
+                }
+            }
+
+            if (result.vertices.size() > kMaxMeshletVertices) {
+                throw std::length_error("Encoded meshlet exceeds the maximum number of vertices");
+            }
+            return result;
+        }
+
+    private:
+        // depth-first search over all emissions whose triangles are degenerate except the last one
+        bool Search(const Triangle& triangle, const Triangle* next, const std::array<int, 4>& candidates, int length)
+        {
+            for (const int v : candidates) {
+                for (const bool flag : {kLeft, kRight}) {
+                    Emit(v, flag);
+                    const auto decoded = Decode(Size() - 1);
+                    if (length == 1) {
+                        if (IsSameTriangle(decoded, triangle) && (next == nullptr || CanContinue(v, triangle, *next))) {
+                            return true;
+                        }
+                    } else if (IsDegenerate(decoded) && Search(triangle, next, candidates, length - 1)) {
+                        return true;
+                    }
+                    Undo(1);
+                }
+            }
+            return false;
+        }
+
+        // an edge-adjacent next triangle can only be appended directly if it contains the last vertex
+        static bool CanContinue(int last, const Triangle& triangle, const Triangle& next)
+        {
+            int shared = 0;
+            for (const int v : triangle) {
+                shared += std::find(next.begin(), next.end(), v) != next.end() ? 1 : 0;
+            }
+            return shared != 2 || std::find(next.begin(), next.end(), last) != next.end();
+        }
+
+        static bool IsDegenerate(const Triangle& triangle)
+        {
+            return triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0];
+        }
+
+        void Emit(int vertex, bool flag)
+        {
+            indices_.emplace_back(vertex);
+            flags_.emplace_back(flag);
+        }
+
+        // see LoadTriangleIndex
+        int Index(int t) const
+        {
+            if (t >= 0) {
+                return indices_[t];
+            }
+            return t == -1 ? start_[1] : start_[0];
+        }
+
+        // see LoadTriangleFanOffset. Equals one plus the number of equal flags up to and including t
+        int FanOffset(int t, bool flag) const
+        {
+            int offset = 2;
+            for (int k = t - 1; k >= 0 && flags_[k] == flag; --k) {
+                ++offset;
+            }
+            return offset;
+        }
+
+        Triangle Decode(int t) const
+        {
+            const bool flag = flags_[t];
+            const int  i    = Index(t);
+            const int  p    = Index(t - 1);
+            const int  o    = Index(t - FanOffset(t, flag));
+            return flag ? Triangle{p, o, i} : Triangle{o, p, i};
+        }
+
+        // Rotates the strip's first triangle such that its last vertex lies on the edge shared with next
+        static Triangle Orient(const Triangle& triangle, const Triangle* next)
+        {
+            if (next == nullptr) {
+                return triangle;
+            }
+            for (int r = 0; r < 3; ++r) {
+                const int unshared = triangle[r];
+                if (std::find(next->begin(), next->end(), unshared) == next->end()) {
+                    return {unshared, triangle[(r + 1) % 3], triangle[(r + 2) % 3]};
+                }
+            }
+            return triangle;
+        }
+    };
+
+    Triangle GetTriangle(std::span<const int> triangles, optimal_strips::TriangleId t)
+    {
+        return {triangles[3 * t + 0], triangles[3 * t + 1], triangles[3 * t + 2]};
+    }
+
+    // the decoder tells degenerate triangles between strips apart from the meshlet's triangles only by their repeated
+    // vertices, and triangle 0 always decodes to three distinct local vertices
+    void CheckTriangles(std::span<const int> triangles)
+    {
+        for (std::size_t t = 0; 3 * t < triangles.size(); ++t) {
+            const auto triangle = GetTriangle(triangles, static_cast<optimal_strips::TriangleId>(t));
+            if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) {
+                throw std::invalid_argument("Cannot encode degenerate triangle " + std::to_string(t));
+            }
+        }
+    }
+
+    void WriteStrip(StripWriter& writer, std::span<const int> triangles, const optimal_strips::TriangleStrip& strip)
+    {
+        for (std::size_t k = 0; k < strip.size(); ++k) {
+            const Triangle  triangle = GetTriangle(triangles, strip[k]);
+            const Triangle  second   = k + 1 < strip.size() ? GetTriangle(triangles, strip[k + 1]) : Triangle{};
+            const Triangle* next     = k + 1 < strip.size() ? &second : nullptr;
+            if (writer.Empty()) {
+                writer.Start(triangle, next);
+            } else if (writer.Connect(triangle, next) == 0) {
+                throw std::logic_error("Could not connect triangle to strip");
+            }
+        }
+    }
+
+    StripWriter WriteStrips(std::span<const int> triangles, const std::vector<optimal_strips::TriangleStrip>& strips)
+    {
+        CheckTriangles(triangles);
+        StripWriter writer;
+        for (const auto& strip : strips) {
+            WriteStrip(writer, triangles, strip);
+        }
+        return writer;
+    }
+
+    // Keeps the first strip. Every following strip is the one that connects with the fewest degenerate triangles, in
+    // either direction.
+    std::vector<optimal_strips::TriangleStrip> OrderStrips(std::span<const int>                              triangles,
+                                                           const std::vector<optimal_strips::TriangleStrip>& strips)
+    {
+        CheckTriangles(triangles);
+
+        std::vector<optimal_strips::TriangleStrip> remaining;
+        std::copy_if(strips.begin(), strips.end(), std::back_inserter(remaining), [](const auto& strip) {
+            return !strip.empty();
+        });
+
+        std::vector<optimal_strips::TriangleStrip> result;
+        StripWriter                                writer;
+        while (!remaining.empty()) {
+            std::size_t best         = 0;
+            bool        bestReversed = false;
+            int         bestLength   = kRestartTriangles + 2;
+
+            for (std::size_t s = 0; s < remaining.size() && !writer.Empty() && bestLength > 1; ++s) {
+                for (const bool reversed : {false, true}) {
+                    auto strip = remaining[s];
+                    if (reversed) {
+                        std::reverse(strip.begin(), strip.end());
+                    }
+                    const Triangle  second = strip.size() > 1 ? GetTriangle(triangles, strip[1]) : Triangle{};
+                    const Triangle* next   = strip.size() > 1 ? &second : nullptr;
+                    // only look for connections shorter than the best so far
+                    const int       length = writer.Connect(GetTriangle(triangles, strip[0]), next, bestLength - 1);
+                    writer.Undo(length);
+                    if (length > 0) {
+                        best         = s;
+                        bestReversed = reversed;
+                        bestLength   = length;
+                    }
+                }
+            }
+
+            auto strip = std::move(remaining[best]);
+            remaining.erase(remaining.begin() + best);
+            if (bestReversed) {
+                std::reverse(strip.begin(), strip.end());
+            }
+            WriteStrip(writer, triangles, strip);
+            result.emplace_back(std::move(strip));
+        }
+        return result;
+    }
+
+    std::vector<optimal_strips::TriangleStrip> CreateMeshletStrips(std::span<const int>                triangles,
+                                                                   const optimal_strips::StripOptions& options)
+    {
+        const auto solver = optimal_strips::CreateSolver();
+        return CreateMeshletStrips(triangles, options, *solver);
+    }
+
+    std::vector<optimal_strips::TriangleStrip> CreateMeshletStrips(std::span<const int>                triangles,
+                                                                   const optimal_strips::StripOptions& options,
+                                                                   milp::MILPSolverBase&               solver)
+    {
+        auto strips = optimal_strips::CreateTriangleStrips(triangles, options, solver);
+        if (options.allowBridges) {
+            // the optimizer already links strip ends that could be joined for less than a restart
+            return strips;
+        }
+        return OrderStrips(triangles, strips);
+    }
+
+    int EncodedPrimitiveCount(std::span<const int> triangles, const std::vector<optimal_strips::TriangleStrip>& strips)
+    {
+        return WriteStrips(triangles, strips).Size();
+    }
+
+    EncodedMeshlet EncodeMeshlet(std::span<const int>                              triangles,
+                                 const std::vector<optimal_strips::TriangleStrip>& strips)
+    {
+        return WriteStrips(triangles, strips).Finish();
+    }
+
+    // The functions below mirror GTS.hlsl, operating on the encoded data instead of IndexBufferCache
+
+    bool LoadTriangleFlag(std::span<const std::uint32_t> cache, int triangleIndex)
+    {
+        return cache[triangleIndex / 32] & (1u << (triangleIndex % 32));
+    }
+
+    std::uint32_t LoadLast32TriangleFlags(std::span<const std::uint32_t> cache, int triangleIndex)
+    {
+        const int     dwordIndex = triangleIndex / 32;
+        const int     bitIndex   = triangleIndex % 32;
+        std::uint32_t lastFlags  = cache[dwordIndex] << (31 - bitIndex);
+        if (dwordIndex != 0 && bitIndex != 31) {
+            lastFlags |= cache[dwordIndex - 1] >> (bitIndex + 1);
+        }
+        return lastFlags;
+    }
+
+    int LoadTriangleFanOffset(std::span<const std::uint32_t> cache, int triangleIndex, bool triangleFlag)
+    {
+        std::uint32_t lastFlags;
+        int           fanOffset = 1;
+        do {
+            lastFlags = LoadLast32TriangleFlags(cache, triangleIndex);
+            lastFlags = triangleFlag ? ~lastFlags : lastFlags;
+            // 31 - firstbithigh
+            fanOffset += std::countl_zero(lastFlags);
+            triangleIndex -= 32;
+        } while ((lastFlags == 0) && (triangleIndex >= 0));
+        return fanOffset;
+    }
+
+    std::uint32_t LoadTriangleIndex(std::span<const std::uint32_t> cache, int triangleIndex)
+    {
+        if (triangleIndex <= 0) {
+            return std::max(triangleIndex + 2, 0);
+        }
+        const int index = triangleIndex - 1;
+        return (cache[kTriangleFlagDwords + index / 4] >> ((index % 4) * 8)) & 0xFF;
+    }
+
+    std::vector<std::array<std::uint32_t, 3>> DecodeMeshlet(const EncodedMeshlet& meshlet)
+    {
+        std::vector<std::array<std::uint32_t, 3>> result;
+        result.reserve(meshlet.primitiveCount);
+        for (int t = 0; t < static_cast<int>(meshlet.primitiveCount); ++t) {
+            const bool flag      = LoadTriangleFlag(meshlet.data, t);
+            const int  fanOffset = LoadTriangleFanOffset(meshlet.data, t, flag);
+            const auto i         = LoadTriangleIndex(meshlet.data, t);
+            const auto p         = LoadTriangleIndex(meshlet.data, t - 1);
+            const auto o         = LoadTriangleIndex(meshlet.data, t - fanOffset);
+            result.push_back(flag ? std::array{p, o, i} : std::array{o, p, i});
+        }
+        return result;
+    }
+}  // namespace gts
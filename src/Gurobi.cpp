@@ -10,6 +10,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "Gurobi.h"
 
+#include <stdexcept>
+
 namespace gurobi {
     GUROBISolver::GUROBISolver() : env_(true)
     {
@@ -62,7 +64,7 @@ namespace gurobi {
         model_->optimize();
         int optimstatus = model_->get(GRB_IntAttr_Status);
         if (optimstatus != GRB_OPTIMAL) {
-            throw std::exception("Could not find optimal solution!");
+            throw std::runtime_error("Could not find optimal solution!");
         }
     }
 
@@ -71,6 +73,15 @@ namespace gurobi {
         return variables_[v].get(GRB_DoubleAttr_X);
     }
 
+    void GUROBISolver::Reset()
+    {
+        // the environment holds the license and is reused
+        variables_.clear();
+        objective_ = GRBLinExpr();
+        model_     = std::make_unique<GRBModel>(env_);
+        model_->set(GRB_IntParam_LogToConsole, 0);
+    }
+
     milp::Variable GUROBISolver::AddVariableImpl(double min, double max, double objFactor, char type)
     {
         variables_.emplace_back(model_->addVar(min, max, 0., type));
@@ -14,7 +14,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <algorithm>
 #include <cassert>
 #include <deque>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <unordered_map>
 
 #ifdef HAS_GUROBI
@@ -72,15 +74,6 @@ namespace optimal_strips {
         return result;
     }
 
-    // helper function to quickly navigate the dual graph
-    int EdgeMapOther(const std::pair<TriangleId, TriangleId>& pair, TriangleId cmp)
-    {
-        if (pair.first == cmp) {
-            return pair.second;
-        }
-        return pair.first;
-    }
-
     class StripOptimizer {
     public:
     protected:
@@ -89,13 +82,24 @@ namespace optimal_strips {
         std::vector<Edge>                              dualEdgeIdToEdge_;
         std::unordered_map<Edge, int, EdgeMap::hasher> edgeToDualEdgeId_;
 
-        std::unique_ptr<milp::MILPSolverBase>                  solver_;
+        StripOptions                                   options_;
+        // pairs of triangles that only share a single vertex, see StripOptions::allowBridges
+        std::vector<std::pair<TriangleId, TriangleId>> bridges_;
+        std::vector<std::vector<int>>                  triangleToBridgeIds_;
+
+        milp::MILPSolverBase&                                  solver_;
         std::vector<milp::Variable>                            x_;
         std::vector<std::pair<milp::Variable, milp::Variable>> y_;
+        std::vector<milp::Variable>                            b_;
+        std::vector<std::pair<milp::Variable, milp::Variable>> yBridge_;
 
     public:
-        StripOptimizer(std::span<const int> indices, std::unique_ptr<milp::MILPSolverBase>&& optimizer)
-            : solver_(std::move(optimizer)), indices_(indices), edgeMap_(ComputeEdgeMap(indices))
+        StripOptimizer(std::span<const int> indices, const StripOptions& options, milp::MILPSolverBase& optimizer)
+            : solver_(optimizer),
+              indices_(indices),
+              edgeMap_(ComputeEdgeMap(indices)),
+              options_(options),
+              triangleToBridgeIds_(indices.size() / 3)
         {
             for (const auto& [key, triangles] : edgeMap_) {
                 const auto& [left, right] = triangles;
@@ -105,29 +109,78 @@ namespace optimal_strips {
                     dualEdgeIdToEdge_.emplace_back(key);
                 }
             }
+
+            // a bridge only pays off if it is cheaper than a restart
+            if (options_.allowBridges && options_.bridgeCost < options_.restartCost) {
+                ComputeBridges();
+            }
         }
 
         std::vector<TriangleStrip> operator()()
         {
             CreateVariables();
             CreateConstraints();
-            solver_->SetObjective(true);
-            std::vector<bool> edgeIsInStrip = Run();
-            return ExtractStrips(edgeIsInStrip);
+            solver_.SetObjective(true);
+            std::vector<std::vector<TriangleId>> links = Run();
+            return ExtractStrips(links);
         }
 
     protected:
+        void ComputeBridges()
+        {
+            std::unordered_map<int, std::vector<TriangleId>> vertexToTriangles;
+            for (int t = 0; t < indices_.size() / 3; ++t) {
+                for (int corner = 0; corner < 3; ++corner) {
+                    vertexToTriangles[indices_[3 * t + corner]].emplace_back(t);
+                }
+            }
+
+            const auto sharedVertices = [&](TriangleId a, TriangleId b) {
+                int shared = 0;
+                for (int i = 0; i < 3; ++i) {
+                    for (int j = 0; j < 3; ++j) {
+                        shared += indices_[3 * a + i] == indices_[3 * b + j] ? 1 : 0;
+                    }
+                }
+                return shared;
+            };
+
+            for (const auto& [vertex, triangles] : vertexToTriangles) {
+                for (int i = 0; i < triangles.size(); ++i) {
+                    for (int j = i + 1; j < triangles.size(); ++j) {
+                        // triangles sharing an edge are connected by a dual edge instead
+                        if (sharedVertices(triangles[i], triangles[j]) != 1) {
+                            continue;
+                        }
+                        triangleToBridgeIds_[triangles[i]].emplace_back(static_cast<int>(bridges_.size()));
+                        triangleToBridgeIds_[triangles[j]].emplace_back(static_cast<int>(bridges_.size()));
+                        bridges_.emplace_back(triangles[i], triangles[j]);
+                    }
+                }
+            }
+        }
+
         void CreateVariables()
         {
+            // maximizing the saved restarts minimizes the encoded size
             x_.reserve(dualEdgeIdToEdge_.size());
             for (int i = 0; i < dualEdgeIdToEdge_.size(); i++) {
-                x_.emplace_back(solver_->AddBinaryVariable(1.0));
+                x_.emplace_back(solver_.AddBinaryVariable(options_.restartCost));
             }
 
             y_.reserve(dualEdgeIdToEdge_.size());
             for (int i = 0; i < dualEdgeIdToEdge_.size(); i++) {
-                y_.emplace_back(std::make_pair(solver_->AddVariable(0.0, std::numeric_limits<double>::max(), 0.0),
-                                               solver_->AddVariable(0.0, std::numeric_limits<double>::max(), 0.0)));
+                y_.emplace_back(std::make_pair(solver_.AddVariable(0.0, std::numeric_limits<double>::max(), 0.0),
+                                               solver_.AddVariable(0.0, std::numeric_limits<double>::max(), 0.0)));
+            }
+
+            b_.reserve(bridges_.size());
+            yBridge_.reserve(bridges_.size());
+            for (int i = 0; i < bridges_.size(); i++) {
+                b_.emplace_back(solver_.AddBinaryVariable(options_.restartCost - options_.bridgeCost));
+                yBridge_.emplace_back(
+                    std::make_pair(solver_.AddVariable(0.0, std::numeric_limits<double>::max(), 0.0),
+                                   solver_.AddVariable(0.0, std::numeric_limits<double>::max(), 0.0)));
             }
         }
 
@@ -160,12 +213,16 @@ namespace optimal_strips {
                         sumY += y_[edgeIdx].second;
                     }
                 }
-                if (numberOfDualEdges == 3) {
+                for (const int bridgeId : triangleToBridgeIds_[t]) {
+                    sumX += b_[bridgeId];
+                    sumY += bridges_[bridgeId].first == t ? yBridge_[bridgeId].first : yBridge_[bridgeId].second;
+                }
+                if (numberOfDualEdges + triangleToBridgeIds_[t].size() >= 3) {
                     // anti-fork constraint
-                    solver_->AddConstraint(sumX, milp::Comparison::LESS_EQUAL, 2.0);
+                    solver_.AddConstraint(sumX, milp::Comparison::LESS_EQUAL, 2.0);
                 }
                 // anti-cycle constraint per triangle
-                solver_->AddConstraint(sumY, milp::Comparison::LESS_EQUAL, F - epsilon);
+                solver_.AddConstraint(sumY, milp::Comparison::LESS_EQUAL, F - epsilon);
             }
 
             for (int eIdx = 0; eIdx < dualEdgeIdToEdge_.size(); eIdx++) {
@@ -174,26 +231,47 @@ namespace optimal_strips {
                 e += y_[eIdx].first;
                 e += y_[eIdx].second;
                 // anti-cycle constraint per edge
-                solver_->AddConstraint(e, milp::Comparison::EQUAL, 0.0);
+                solver_.AddConstraint(e, milp::Comparison::EQUAL, 0.0);
+            }
+
+            for (int bridgeId = 0; bridgeId < bridges_.size(); bridgeId++) {
+                milp::LinearExpression e;
+                e += milp::LinearExpression(-F, b_[bridgeId]);
+                e += yBridge_[bridgeId].first;
+                e += yBridge_[bridgeId].second;
+                // anti-cycle constraint per bridge
+                solver_.AddConstraint(e, milp::Comparison::EQUAL, 0.0);
             }
         }
 
-        std::vector<bool> Run()
+        // returns the neighbors of every triangle in its strip
+        std::vector<std::vector<TriangleId>> Run()
         {
-            solver_->Optimize();
-            std::vector<bool> edgeIsInStrip;
-            for (const auto& v : x_) {
+            solver_.Optimize();
+            std::vector<std::vector<TriangleId>> links(indices_.size() / 3);
+            for (int eIdx = 0; eIdx < x_.size(); eIdx++) {
                 // solvers sometimes output booleans 0 <= b <= 1...
-                edgeIsInStrip.emplace_back(solver_->GetSolutionVariableValue(v) > 0.5);
+                if (solver_.GetSolutionVariableValue(x_[eIdx]) > 0.5) {
+                    const auto& [left, right] = edgeMap_.at(dualEdgeIdToEdge_[eIdx]);
+                    links[left].emplace_back(right);
+                    links[right].emplace_back(left);
+                }
             }
-            return edgeIsInStrip;
+            for (int bridgeId = 0; bridgeId < b_.size(); bridgeId++) {
+                if (solver_.GetSolutionVariableValue(b_[bridgeId]) > 0.5) {
+                    const auto& [first, second] = bridges_[bridgeId];
+                    links[first].emplace_back(second);
+                    links[second].emplace_back(first);
+                }
+            }
+            return links;
         }
 
-        void Visit(TriangleId               t,
-                   bool                     front,
-                   std::deque<TriangleId>&  strip,
-                   std::vector<bool>&       visitedTriangles,
-                   const std::vector<bool>& edgeIsInStrip)
+        void Visit(TriangleId                                  t,
+                   bool                                        front,
+                   std::deque<TriangleId>&                     strip,
+                   std::vector<bool>&                          visitedTriangles,
+                   const std::vector<std::vector<TriangleId>>& links)
         {
             TriangleId oldEnd = -1;
             if (strip.size() != 1) {
@@ -206,31 +284,20 @@ namespace optimal_strips {
 
             visitedTriangles[t] = true;
             int nVisited        = 0;
-            for (int i = 0; i < 3; ++i) {
-                const auto uniqueEdge = std::minmax(indices_[3 * t + i], indices_[3 * t + ((i + 1) % 3)]);
-                auto       other      = EdgeMapOther(edgeMap_.at(uniqueEdge), t);
-
-                auto itr = edgeToDualEdgeId_.find(uniqueEdge);
-                if (itr == edgeToDualEdgeId_.end()) {
-                    continue;
-                }
-                auto dualEdgeId = itr->second;
-                if (!edgeIsInStrip[dualEdgeId]) {
-                    continue;
-                }
+            for (const TriangleId other : links[t]) {
                 if (other != oldEnd) {
                     assert(nVisited == 0);
                     if (visitedTriangles[other]) {
                         auto side = (front ? strip.back() : strip.front());
                         assert(side == other);
-                        throw std::exception("Strip contains circles!");
+                        throw std::runtime_error("Strip contains circles!");
                     }
                     if (front) {
                         strip.push_front(other);
                     } else {
                         strip.push_back(other);
                     }
-                    Visit(other, front, strip, visitedTriangles, edgeIsInStrip);
+                    Visit(other, front, strip, visitedTriangles, links);
                     if (oldEnd == -1) {
                         return;
                     }
@@ -239,7 +306,7 @@ namespace optimal_strips {
             }
         }
 
-        std::vector<TriangleStrip> ExtractStrips(const std::vector<bool>& edgeIsInStrip)
+        std::vector<TriangleStrip> ExtractStrips(const std::vector<std::vector<TriangleId>>& links)
         {
             std::vector<std::deque<TriangleId>> triangleStrips;
             std::vector<bool>                   visitedTriangles(indices_.size() / 3, false);
@@ -250,8 +317,8 @@ namespace optimal_strips {
                 }
                 std::deque<TriangleId> strip;
                 strip.push_back(f);
-                Visit(f, false, strip, visitedTriangles, edgeIsInStrip);
-                Visit(f, true, strip, visitedTriangles, edgeIsInStrip);
+                Visit(f, false, strip, visitedTriangles, links);
+                Visit(f, true, strip, visitedTriangles, links);
                 triangleStrips.emplace_back(std::move(strip));
             }
 
@@ -266,11 +333,30 @@ namespace optimal_strips {
     };
 
     std::vector<TriangleStrip> CreateTriangleStrips(std::span<const int> triangles)
+    {
+        return CreateTriangleStrips(triangles, StripOptions());
+    }
+
+    std::vector<TriangleStrip> CreateTriangleStrips(std::span<const int> triangles, const StripOptions& options)
+    {
+        const auto solver = CreateSolver();
+        return StripOptimizer(triangles, options, *solver)();
+    }
+
+    std::vector<TriangleStrip> CreateTriangleStrips(std::span<const int>  triangles,
+                                                    const StripOptions&   options,
+                                                    milp::MILPSolverBase& solver)
+    {
+        solver.Reset();
+        return StripOptimizer(triangles, options, solver)();
+    }
+
+    std::unique_ptr<milp::MILPSolverBase> CreateSolver()
     {
 #ifdef HAS_GUROBI
-        return StripOptimizer(triangles, std::make_unique<gurobi::GUROBISolver>())();
+        return std::make_unique<gurobi::GUROBISolver>();
 #else
-        return StripOptimizer(triangles, std::make_unique<scip::SCIPSolver>())();
+        return std::make_unique<scip::SCIPSolver>();
 #endif
     }
 }  // namespace optimal_strips
@@ -11,6 +11,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <SCIP.h>
 #include <scip/scipdefplugins.h>
 
+#include <stdexcept>
+
 namespace scip {
     SCIPSolver::SCIPSolver()
     {
@@ -22,6 +24,9 @@ namespace scip {
 
     SCIPSolver::~SCIPSolver()
     {
+        for (auto& variable : variables_) {
+            SCIPreleaseVar(scip_, &variable);
+        }
         SCIPfree(&scip_);
     }
 
@@ -58,6 +63,7 @@ namespace scip {
             SCIPthrow(SCIPaddCoefLinear(scip_, constraint, variables_[v], factor));
         }
         SCIPthrow(SCIPaddCons(scip_, constraint));
+        SCIPthrow(SCIPreleaseCons(scip_, &constraint));
     };
 
     void SCIPSolver::SetObjective(bool maximize)
@@ -76,6 +82,16 @@ namespace scip {
         return SCIPgetSolVal(scip_, sol, variables_[v]);
     }
 
+    void SCIPSolver::Reset()
+    {
+        for (auto& variable : variables_) {
+            SCIPthrow(SCIPreleaseVar(scip_, &variable));
+        }
+        variables_.clear();
+        SCIPthrow(SCIPfreeProb(scip_));
+        SCIPthrow(SCIPcreateProbBasic(scip_, ""));
+    }
+
     milp::Variable SCIPSolver::AddVariableImpl(double min, double max, double objFactor, SCIP_VARTYPE type)
     {
         variables_.emplace_back();
@@ -87,7 +103,7 @@ namespace scip {
     void SCIPSolver::SCIPthrow(SCIP_RETCODE code)
     {
         if (code != SCIP_OKAY) {
-            throw std::exception("SCIP failed");
+            throw std::runtime_error("SCIP failed");
         }
     }
 }  // namespace scip
@@ -0,0 +1,116 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Stand-in for an editor or asset pipeline: submits an OBJ mesh to the cook daemon and prints the meshlets as they
+// are streamed back.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "Cook.h"
+
+// Reads positions and faces of an OBJ file. Polygons are split into triangle fans.
+void ReadObj(const std::string& path, std::vector<float>& positions, std::vector<int>& indices)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string        type;
+        stream >> type;
+        if (type == "v") {
+            float x = 0.f, y = 0.f, z = 0.f;
+            stream >> x >> y >> z;
+            positions.insert(positions.end(), {x, y, z});
+        } else if (type == "f") {
+            std::vector<int> face;
+            std::string      corner;
+            while (stream >> corner) {
+                // v, v/vt, v//vn or v/vt/vn with 1-based or negative relative indices
+                const int index = std::stoi(corner.substr(0, corner.find('/')));
+                face.emplace_back(index < 0 ? static_cast<int>(positions.size() / 3) + index : index - 1);
+            }
+            for (std::size_t i = 2; i < face.size(); ++i) {
+                indices.insert(indices.end(), {face[0], face[i - 1], face[i]});
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string socketPath = cook::DefaultSocketPath();
+    std::string objPath;
+    cook::Job   job;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (arg == "--interactive") {
+            job.priority = cook::Priority::INTERACTIVE;
+        } else if (arg == "--bridged") {
+            job.bridgedStrips = true;
+        } else if (arg == "--meshlet") {
+            job.kind = cook::JobKind::MESHLET;
+        } else if (objPath.empty() && !arg.starts_with("--")) {
+            objPath = arg;
+        } else {
+            objPath.clear();
+            break;
+        }
+    }
+    if (objPath.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--socket path] [--interactive] [--bridged] [--meshlet] mesh.obj"
+                  << std::endl;
+        return 1;
+    }
+
+    try {
+        ReadObj(objPath, job.positions, job.indices);
+
+        const auto   start = std::chrono::steady_clock::now();
+        cook::Client client(socketPath);
+        client.Submit(std::move(job));
+
+        const auto elapsed = [&]() {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        std::size_t dwords = 0;
+        while (auto response = client.Receive()) {
+            if (const auto* meshlet = std::get_if<cook::MeshletResult>(&*response)) {
+                dwords += meshlet->encoded.data.size();
+                std::cout << elapsed() << " ms: " << meshlet->triangles.size() / 3 << " triangles, "
+                          << meshlet->encoded.vertices.size() << " vertices, " << meshlet->encoded.primitiveCount
+                          << " primitives, " << meshlet->encoded.data.size() << " DWORDs"
+                          << (meshlet->cached ? " (cached)" : "") << std::endl;
+            } else if (const auto* complete = std::get_if<cook::JobComplete>(&*response)) {
+                std::cout << elapsed() << " ms: " << complete->meshletCount << " meshlets, " << dwords << " DWORDs"
+                          << std::endl;
+                return 0;
+            } else {
+                std::cerr << "Cook job failed: " << std::get<cook::JobError>(*response).message << std::endl;
+                return 1;
+            }
+        }
+        std::cerr << "Cook daemon closed the connection" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+    return 1;
+}
@@ -0,0 +1,235 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Load generator for the cook daemon. Every client floods the daemon with batch mesh jobs and then submits
+// interactive meshlet jobs, reporting the latency of both priority classes.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Cook.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadOptions {
+    std::string socketPath      = cook::DefaultSocketPath();
+    int         clients         = 4;
+    int         batchJobs       = 8;
+    // quads per side of a batch mesh
+    int         gridSize        = 48;
+    // distinct batch meshes, repeated meshes are served from the cache of the daemon
+    int         variants        = 4;
+    int         interactiveJobs = 16;
+    int         intervalMs      = 50;
+    bool        bridgedStrips   = false;
+};
+
+struct Statistics {
+    std::mutex          mutex;
+    std::vector<double> latencies[2];
+    std::uint64_t       meshlets  = 0;
+    std::uint64_t       cacheHits = 0;
+    std::uint64_t       errors    = 0;
+};
+
+// A grid mesh whose quad diagonals are chosen by the seed, so that different seeds yield different topologies
+cook::Job MakeGrid(int size, std::uint32_t seed)
+{
+    cook::Job job;
+    for (int y = 0; y <= size; ++y) {
+        for (int x = 0; x <= size; ++x) {
+            job.positions.insert(job.positions.end(), {static_cast<float>(x), static_cast<float>(y), 0.f});
+        }
+    }
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const int a = y * (size + 1) + x;
+            const int b = a + 1;
+            const int c = a + size + 1;
+            const int d = c + 1;
+
+            std::uint32_t hash = seed * 0x9e3779b9u ^ static_cast<std::uint32_t>(a) * 0x85ebca6bu;
+            hash ^= hash >> 15;
+            hash *= 0x2c1b3c6du;
+            if ((hash >> 16) & 1) {
+                job.indices.insert(job.indices.end(), {a, b, d, a, d, c});
+            } else {
+                job.indices.insert(job.indices.end(), {a, b, c, b, d, c});
+            }
+        }
+    }
+    return job;
+}
+
+double Percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) {
+        return 0.;
+    }
+    const auto n = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + n, values.end());
+    return values[n];
+}
+
+void RunClient(const LoadOptions& options, int clientIndex, Statistics& statistics)
+{
+    cook::Client client(options.socketPath);
+
+    std::mutex                                                            mutex;
+    std::map<std::uint64_t, std::pair<cook::Priority, Clock::time_point>> submitted;
+    const int          jobCount = options.batchJobs + options.interactiveJobs;
+    std::exception_ptr receiveError;
+
+    std::thread receiver([&]() {
+        for (int done = 0; done < jobCount;) {
+            std::optional<cook::Response> response;
+            try {
+                response = client.Receive();
+                if (!response) {
+                    throw std::runtime_error("Cook daemon closed the connection");
+                }
+            } catch (...) {
+                receiveError = std::current_exception();
+                return;
+            }
+            const auto now = Clock::now();
+
+            std::lock_guard lock(statistics.mutex);
+            if (const auto* meshlet = std::get_if<cook::MeshletResult>(&*response)) {
+                ++statistics.meshlets;
+                statistics.cacheHits += meshlet->cached ? 1 : 0;
+                continue;
+            }
+
+            const auto jobId = std::visit([](const auto& r) { return r.jobId; }, *response);
+            std::pair<cook::Priority, Clock::time_point> job;
+            {
+                std::lock_guard submittedLock(mutex);
+                job = submitted.at(jobId);
+            }
+            if (std::holds_alternative<cook::JobError>(*response)) {
+                ++statistics.errors;
+            } else {
+                statistics.latencies[static_cast<int>(job.first)].emplace_back(
+                    std::chrono::duration<double, std::milli>(now - job.second).count());
+            }
+            ++done;
+        }
+    });
+
+    const auto submit = [&](cook::Job&& job) {
+        job.bridgedStrips = options.bridgedStrips;
+        // the lock keeps the receiver from seeing a response before the job is recorded
+        std::lock_guard lock(mutex);
+        const auto      priority = job.priority;
+        const auto      time     = Clock::now();
+        const auto      id       = client.Submit(std::move(job));
+        submitted[id]            = {priority, time};
+    };
+
+    // a failed submit means the daemon is gone, which also ends the receiver
+    std::exception_ptr submitError;
+    try {
+        for (int i = 0; i < options.batchJobs; ++i) {
+            auto job     = MakeGrid(options.gridSize, static_cast<std::uint32_t>((clientIndex + i) % options.variants));
+            job.priority = cook::Priority::BATCH;
+            job.kind     = cook::JobKind::MESH;
+            submit(std::move(job));
+        }
+        for (int i = 0; i < options.interactiveJobs; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.intervalMs));
+            // a single meshlet with a unique topology, as edited interactively
+            auto job     = MakeGrid(8, static_cast<std::uint32_t>(1000 + clientIndex * options.interactiveJobs + i));
+            job.priority = cook::Priority::INTERACTIVE;
+            job.kind     = cook::JobKind::MESHLET;
+            job.positions.clear();
+            submit(std::move(job));
+        }
+    } catch (...) {
+        submitError = std::current_exception();
+    }
+    receiver.join();
+    if (submitError || receiveError) {
+        std::rethrow_exception(submitError ? submitError : receiveError);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            options.socketPath = argv[++i];
+        } else if (arg == "--clients" && i + 1 < argc) {
+            options.clients = std::stoi(argv[++i]);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            options.batchJobs = std::stoi(argv[++i]);
+        } else if (arg == "--grid" && i + 1 < argc) {
+            options.gridSize = std::stoi(argv[++i]);
+        } else if (arg == "--variants" && i + 1 < argc) {
+            options.variants = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--interactive" && i + 1 < argc) {
+            options.interactiveJobs = std::stoi(argv[++i]);
+        } else if (arg == "--interval" && i + 1 < argc) {
+            options.intervalMs = std::stoi(argv[++i]);
+        } else if (arg == "--bridged") {
+            options.bridgedStrips = true;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--socket path] [--clients count] [--batch jobs] [--grid quads] [--variants count]"
+                         " [--interactive jobs] [--interval ms] [--bridged]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    Statistics               statistics;
+    std::atomic<int>         failedClients = 0;
+    std::vector<std::thread> clients;
+    const auto               start = Clock::now();
+    for (int i = 0; i < options.clients; ++i) {
+        clients.emplace_back([&, i]() {
+            try {
+                RunClient(options, i, statistics);
+            } catch (const std::exception& e) {
+                ++failedClients;
+                std::cerr << "Client " << i << ": " << e.what() << std::endl;
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const char* names[] = {"interactive", "batch"};
+    for (int priority = 0; priority < 2; ++priority) {
+        const auto& latencies = statistics.latencies[priority];
+        std::cout << names[priority] << ": " << latencies.size() << " jobs, latency p50 "
+                  << Percentile(latencies, 0.5) << " ms, p95 " << Percentile(latencies, 0.95) << " ms, max "
+                  << Percentile(latencies, 1.) << " ms" << std::endl;
+    }
+    std::cout << statistics.meshlets << " meshlets (" << statistics.cacheHits << " cached) in " << seconds << " s, "
+              << static_cast<double>(statistics.meshlets) / seconds << " meshlets/s, " << statistics.errors
+              << " failed jobs" << std::endl;
+    return failedClients == 0 && statistics.errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+/*
+Copyright (c) 2023 Bastian Kuth
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <pthread.h>
+#include <signal.h>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "CookServer.h"
+
+int main(int argc, char** argv)
+{
+    cook::ServerOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            options.socketPath = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.workerCount = std::stoi(argv[++i]);
+        } else if (arg == "--interactive-workers" && i + 1 < argc) {
+            options.interactiveWorkerCount = std::stoi(argv[++i]);
+        } else if (arg == "--cache" && i + 1 < argc) {
+            options.cacheCapacity = std::stoul(argv[++i]);
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--socket path] [--workers count] [--interactive-workers count] [--cache meshlets]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    // SIGINT and SIGTERM are handled by a dedicated thread, all other threads inherit the blocked mask
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+    try {
+        cook::Server server(options);
+
+        std::thread([&server, stopSignals]() {
+            int signal = 0;
+            sigwait(&stopSignals, &signal);
+            server.Stop();
+        }).detach();
+
+        std::cout << "Cooking meshlets on " << options.socketPath << std::endl;
+        server.Run();
+
+        const auto statistics = server.GetStatistics();
+        std::cout << statistics.jobs << " jobs (" << statistics.failedJobs << " failed), " << statistics.meshlets
+                  << " meshlets, " << statistics.cacheHits << " cache hits, " << statistics.solves << " solves"
+                  << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
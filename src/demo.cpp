@@ -8,10 +8,47 @@ The above copyright notice and this permission notice shall be included in all c
 THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <ClusterLOD.h>
+#include <GTS.h>
 #include <OptimalStrips.h>
 
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include <iostream>
+#include <vector>
+
+// Sorted triangles with the smallest vertex first, keeping the winding. Degenerate triangles are dropped.
+std::vector<std::array<int, 3>> CanonicalTriangles(const std::vector<std::array<int, 3>>& triangles)
+{
+    std::vector<std::array<int, 3>> result;
+    for (auto triangle : triangles) {
+        if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) {
+            continue;
+        }
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        result.emplace_back(triangle);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// Checks that decoding the encoded meshlet as GTS.hlsl does yields exactly the meshlet's triangles
+bool DecodesToInput(const cluster_lod::Meshlet& meshlet)
+{
+    std::vector<std::array<int, 3>> input;
+    for (std::size_t i = 0; i < meshlet.triangles.size(); i += 3) {
+        input.push_back({meshlet.triangles[i], meshlet.triangles[i + 1], meshlet.triangles[i + 2]});
+    }
+
+    std::vector<std::array<int, 3>> decoded;
+    for (const auto& local : gts::DecodeMeshlet(meshlet.encoded)) {
+        decoded.push_back({meshlet.encoded.vertices[local[0]],
+                           meshlet.encoded.vertices[local[1]],
+                           meshlet.encoded.vertices[local[2]]});
+    }
+    return CanonicalTriangles(input) == CanonicalTriangles(decoded);
+}
 
 int main()
 {
@@ -46,6 +83,43 @@ int main()
 
     const auto strips = optimal_strips::CreateTriangleStrips(std::span(indices, 3 * triangleCount));
 
+    // Compare the encoded size with strips that may continue across triangles sharing a vertex. Bridges pay off
+    // where connectivity is poor, so the comparison is repeated with every fourth triangle removed.
+    std::vector<int> perforated;
+    for (int i = 0; i < triangleCount; ++i) {
+        if (i % 4 != 3) {
+            perforated.insert(perforated.end(), indices + 3 * i, indices + 3 * i + 3);
+        }
+    }
+    for (const auto& [meshName, mesh] : {std::make_pair("demo mesh", std::span<const int>(indices, 3 * triangleCount)),
+                                         std::make_pair("perforated demo mesh", std::span<const int>(perforated))})
+    {
+        for (const bool bridged : {false, true}) {
+            const auto meshStrips = gts::CreateMeshletStrips(
+                mesh, bridged ? gts::kBridgedStripOptions : optimal_strips::StripOptions());
+            const auto encoded    = gts::EncodeMeshlet(mesh, meshStrips);
+            std::cout << meshName << (bridged ? ", bridged strips: " : ", strips: ") << meshStrips.size()
+                      << " strips, " << encoded.primitiveCount << " primitives, " << encoded.data.size() << " DWORDs\n";
+        }
+    }
+
+    // build a level of detail hierarchy from small meshlets and verify the encoding of every meshlet
+    std::vector<float> positions3d;
+    for (int i = 0; i < positionCount; ++i) {
+        positions3d.insert(positions3d.end(), {positions[2 * i + 0], positions[2 * i + 1], 0.f});
+    }
+    const auto dag = cluster_lod::BuildClusterDAG(
+        positions3d, std::span(indices, 3 * triangleCount), {.maxTriangles = 16, .maxVertices = 16});
+    for (std::size_t m = 0; m < dag.meshlets.size(); ++m) {
+        if (!DecodesToInput(dag.meshlets[m])) {
+            std::cerr << "meshlet " << m << " does not decode to its triangles\n";
+            return 1;
+        }
+    }
+    const auto selected = cluster_lod::SelectMeshlets(dag, {0.f, 0.f, 2.f}, 0.01f);
+    std::cout << "cluster DAG: " << dag.meshlets.size() << " meshlets in " << dag.levelCount << " levels, "
+              << selected.size() << " selected\n";
+
     std::ofstream obj("demo.obj");
 
     // write positions